@@ -0,0 +1,316 @@
+// build:  make benchmark    (클라이언트/서버를 빌드하고 기본 행렬로 실행)
+// run  :  ./bench -s 1,10,100 -r 3      (크기 목록, 반복 횟수)
+//         ./bench -n                    (syscall 수 측정 생략: ptrace 패스를 건너뜀)
+//         ./bench -x                    (서버를 띄우지 않고 SERVER_IP/SERVER_PORT 의 서버 사용)
+//
+// 로컬 ./server 를 띄우고, 각 클라이언트/수신 엔진을 크기별로 실행해 비교표를 출력한다.
+//   MB/s(자체) : 클라이언트가 출력한 "평균 속도" (요청 → 마지막 바이트)
+//   MB/s(wall) : 프로세스 시작 → 종료 (연결, 파일 닫기 포함)
+//   CPU        : wait4 로 받은 자식의 user + sys 시간
+//   syscalls   : 별도 실행에서 ptrace 로 센 시스템 콜 수 (프로세스 시작/종료분 포함)
+// 반복 실행 중 중앙값(MB/s, CPU)을 보고한다.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <limits.h>
+#include <arpa/inet.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define MAX_SIZES   16
+#define MAX_REPEAT  15
+#define ECHO_MSGS   2000
+
+// 비교 대상: 클라이언트 + 인자
+typedef struct {
+    const char* label;
+    const char* argv[6];
+} bench_cfg_t;
+
+static const bench_cfg_t cfgs[] = {
+    { "client_stream -e read",   { "client_stream", "-e", "read",   NULL } },
+    { "client_stream -e recv",   { "client_stream", "-e", "recv",   NULL } },
+    { "client_stream -e readv",  { "client_stream", "-e", "readv",  NULL } },
+    { "client_stream -e busypoll", { "client_stream", "-e", "busypoll", NULL } },
+    { "client_stream -e splice", { "client_stream", "-e", "splice", NULL } },
+    { "client_stream -e uring",  { "client_stream", "-e", "uring",  NULL } },
+    { "client_stream -e mmap",   { "client_stream", "-e", "mmap",   NULL } },
+    { "client_stream -e wb",     { "client_stream", "-e", "wb",     NULL } },
+    { "client_stream -e auto",   { "client_stream", "-e", "auto",   NULL } },
+    { "client_stream -c 4",      { "client_stream", "-c", "4",      NULL } },
+    { "recv_client",             { "recv_client",                   NULL } },
+    { "staticclient -a malloc",  { "staticclient", "-a", "malloc",  NULL } },
+    { "staticclient -a pool",    { "staticclient", "-a", "pool",    NULL } },
+};
+static const int ncfg = sizeof(cfgs) / sizeof(cfgs[0]);
+
+static char g_bindir[PATH_MAX];   // 클라이언트 실행 파일 위치 (bench 와 같은 디렉터리)
+static char g_workdir[PATH_MAX];  // 클라이언트가 received_*.bin 을 쓰는 임시 디렉터리
+
+// 실행 한 번의 결과
+typedef struct {
+    double wall;      // 초
+    double cpu;       // 초 (user + sys)
+    double self_mbs;  // 클라이언트가 출력한 평균 속도 (없으면 -1)
+    long   syscalls;  // ptrace 패스에서만 채움
+    int    ok;
+} run_t;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 출력에서 마지막 "평균 속도: X MB/s" 값
+static double parse_speed(const char* out) {
+    const char* key = "평균 속도:";
+    const char* p = out, *last = NULL;
+    while ((p = strstr(p, key)) != NULL) last = p++;
+    double v;
+    if (last && sscanf(last + strlen(key), "%lf", &v) == 1) return v;
+    return -1.0;
+}
+
+// ptrace 로 자식(과 그 스레드)의 시스템 콜 진입 횟수를 센다
+static long trace_syscalls(pid_t pid, int* status) {
+    int s;
+    if (waitpid(pid, &s, 0) < 0 || !WIFSTOPPED(s)) return -1;   // 자식의 SIGSTOP
+    ptrace(PTRACE_SETOPTIONS, pid, 0,
+           PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_EXITKILL);
+    ptrace(PTRACE_SYSCALL, pid, 0, 0);
+
+    long stops = 0;
+    while (1) {
+        pid_t w = waitpid(-1, &s, __WALL);
+        if (w < 0) break;
+        if (WIFEXITED(s) || WIFSIGNALED(s)) {
+            if (w == pid) { *status = s; break; }
+            continue;
+        }
+        int sig = WSTOPSIG(s);
+        if (sig == (SIGTRAP | 0x80)) { stops++; sig = 0; }   // 시스템 콜 진입/탈출
+        else if (sig == SIGTRAP || sig == SIGSTOP) sig = 0;  // exec/clone 이벤트, 새 스레드 시작
+        ptrace(PTRACE_SYSCALL, w, 0, sig);
+    }
+    return stops / 2;
+}
+
+// 클라이언트를 한 번 실행: input 을 stdin 으로 넣고 종료까지 기다린다
+static run_t run_client(const char* const* argv, const char* input, int trace) {
+    run_t r = { 0, 0, -1.0, -1, 0 };
+    int in[2];
+    char outpath[] = "/tmp/bench_out_XXXXXX";
+    int outfd = mkstemp(outpath);
+    if (outfd < 0 || pipe(in) < 0) return r;
+    unlink(outpath);
+
+    char exe[PATH_MAX + 64];
+    snprintf(exe, sizeof(exe), "%s/%s", g_bindir, argv[0]);
+
+    double t0 = now_s();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(outfd, STDOUT_FILENO);
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDERR_FILENO);
+        close(in[0]); close(in[1]); close(outfd); close(devnull);
+        if (chdir(g_workdir) < 0) _exit(127);
+        if (trace) {
+            ptrace(PTRACE_TRACEME, 0, 0, 0);
+            raise(SIGSTOP);
+        }
+        execv(exe, (char* const*)argv);
+        _exit(127);
+    }
+    close(in[0]);
+    size_t len = strlen(input);   // 입력은 파이프 용량보다 작게 유지
+    if (write(in[1], input, len) != (ssize_t)len) perror("입력 전달 실패");
+    close(in[1]);
+
+    int status = 0;
+    struct rusage ru;
+    if (trace) {
+        r.syscalls = trace_syscalls(pid, &status);
+    } else {
+        wait4(pid, &status, 0, &ru);
+        r.cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+              + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+    }
+    r.wall = now_s() - t0;
+    r.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    char out[64 * 1024];
+    ssize_t n = pread(outfd, out, sizeof(out) - 1, 0);
+    out[n > 0 ? n : 0] = '\0';
+    close(outfd);
+    r.self_mbs = parse_speed(out);
+    return r;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double* v, int n) {
+    qsort(v, (size_t)n, sizeof(double), cmp_double);
+    return v[n / 2];
+}
+
+// 서버 실행 후 접속될 때까지 대기
+static pid_t start_server(const char* mode, int port) {
+    char exe[PATH_MAX + 16], portstr[16];
+    snprintf(exe, sizeof(exe), "%s/server", g_bindir);
+    snprintf(portstr, sizeof(portstr), "%d", port);
+    pid_t pid = fork();
+    if (pid == 0) {
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        execl(exe, "server", "-q", "-m", mode, "-p", portstr, (char*)NULL);
+        _exit(127);
+    }
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port   = htons((uint16_t)port);
+    inet_pton(AF_INET, "127.0.0.1", &a.sin_addr);
+    for (int i = 0; i < 200; i++) {
+        int s = socket(AF_INET, SOCK_STREAM, 0);
+        int ok = connect(s, (struct sockaddr*)&a, sizeof(a)) == 0;
+        if (ok) write(s, "exit", 4);
+        close(s);
+        if (ok) return pid;
+        usleep(10000);
+    }
+    fprintf(stderr, "서버(%s) 시작 실패\n", mode);
+    kill(pid, SIGTERM);
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    int sizes[MAX_SIZES] = { 1, 10, 100 };
+    int nsizes = 3, repeat = 3, count_syscalls = 1, external = 0;
+    int port = 18888;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:r:p:nx")) != -1) {
+        switch (opt) {
+        case 's':
+            nsizes = 0;
+            for (char* t = strtok(optarg, ","); t && nsizes < MAX_SIZES; t = strtok(NULL, ","))
+                sizes[nsizes++] = atoi(t);
+            break;
+        case 'r': repeat = atoi(optarg); break;
+        case 'p': port = atoi(optarg); break;
+        case 'n': count_syscalls = 0; break;
+        case 'x': external = 1; break;
+        default:
+            fprintf(stderr, "사용법: %s [-s 1,10,100] [-r 반복] [-p 포트] [-n] [-x]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repeat < 1) repeat = 1;
+    if (repeat > MAX_REPEAT) repeat = MAX_REPEAT;
+
+    // 실행 파일 위치 = bench 가 있는 디렉터리
+    if (!realpath(argv[0], g_bindir)) { perror("realpath"); return 1; }
+    *strrchr(g_bindir, '/') = '\0';
+    snprintf(g_workdir, sizeof(g_workdir), "/tmp/bench_XXXXXX");
+    if (!mkdtemp(g_workdir)) { perror("mkdtemp"); return 1; }
+
+    pid_t srv = -1, echo_srv = -1;
+    char portstr[16], echo_portstr[16];
+    if (external) {
+        const char* p = getenv("SERVER_PORT");
+        port = (p && *p) ? atoi(p) : 8888;
+    } else {
+        if ((srv = start_server("stream", port)) < 0) return 1;
+        if ((echo_srv = start_server("echo", port + 1)) < 0) { kill(srv, SIGTERM); return 1; }
+        setenv("SERVER_IP", "127.0.0.1", 1);
+    }
+    snprintf(portstr, sizeof(portstr), "%d", port);
+    snprintf(echo_portstr, sizeof(echo_portstr), "%d", port + 1);
+
+    printf("bench: 서버 %s:%d, 반복 %d회 (중앙값), syscall 측정 %s\n",
+           getenv("SERVER_IP") ? getenv("SERVER_IP") : "115.145.211.117", port,
+           repeat, count_syscalls ? "켜짐" : "꺼짐");
+    printf(" %-26s %6s %12s %12s %10s %10s\n",
+           "클라이언트", "MB", "MB/s(자체)", "MB/s(wall)", "CPU(s)", "syscalls");
+
+    // ===== 다운로드 클라이언트 × 크기 =====
+    setenv("SERVER_PORT", portstr, 1);
+    for (int si = 0; si < nsizes; si++) {
+        char input[64];
+        snprintf(input, sizeof(input), "%d\nexit\n", sizes[si]);
+        for (int ci = 0; ci < ncfg; ci++) {
+            double self[MAX_REPEAT], wall[MAX_REPEAT], cpu[MAX_REPEAT];
+            int ok = 1;
+            for (int k = 0; k < repeat; k++) {
+                run_t r = run_client(cfgs[ci].argv, input, 0);
+                ok &= r.ok;
+                self[k] = r.self_mbs;
+                wall[k] = r.wall > 0 ? sizes[si] / r.wall : 0.0;
+                cpu[k]  = r.cpu;
+            }
+            long sc = count_syscalls ? run_client(cfgs[ci].argv, input, 1).syscalls : -1;
+
+            double s = median(self, repeat);
+            char self_str[24], sc_str[24];
+            if (s >= 0) snprintf(self_str, sizeof(self_str), "%.2f", s);
+            else        snprintf(self_str, sizeof(self_str), "-");
+            if (sc >= 0) snprintf(sc_str, sizeof(sc_str), "%ld", sc);
+            else         snprintf(sc_str, sizeof(sc_str), "-");
+            printf(" %-26s %6d %12s %12.2f %10.4f %10s%s\n",
+                   cfgs[ci].label, sizes[si], self_str, median(wall, repeat),
+                   median(cpu, repeat), sc_str, ok ? "" : "  (실패 있음)");
+        }
+    }
+
+    // ===== 에코 클라이언트: 짧은 메시지 왕복 =====
+    if (!external) {
+        setenv("SERVER_PORT", echo_portstr, 1);
+        static char input[ECHO_MSGS * 8 + 16];
+        size_t off = 0;
+        for (int i = 0; i < ECHO_MSGS; i++) off += (size_t)sprintf(input + off, "ping%02d\n", i % 100);
+        sprintf(input + off, "exit\n");
+        const char* echo_argv[] = { "client", NULL };
+
+        double wall[MAX_REPEAT], cpu[MAX_REPEAT];
+        int ok = 1;
+        for (int k = 0; k < repeat; k++) {
+            run_t r = run_client(echo_argv, input, 0);
+            ok &= r.ok;
+            wall[k] = r.wall;
+            cpu[k]  = r.cpu;
+        }
+        long sc = count_syscalls ? run_client(echo_argv, input, 1).syscalls : -1;
+        double w = median(wall, repeat);
+        char rt_str[24], sc_str[24];
+        if (ok && w > 0) snprintf(rt_str, sizeof(rt_str), "%.0f", ECHO_MSGS / w);
+        else             snprintf(rt_str, sizeof(rt_str), "-");   // 실패한 실행의 시간은 왕복 수가 아님
+        if (sc >= 0) snprintf(sc_str, sizeof(sc_str), "%ld", sc);
+        else         snprintf(sc_str, sizeof(sc_str), "-");
+        printf("\n %-26s %8s %12s %10s %10s\n", "에코", "메시지", "왕복/s", "CPU(s)", "syscalls");
+        printf(" %-26s %8d %12s %10.4f %10s%s\n", "client", ECHO_MSGS, rt_str, median(cpu, repeat),
+               sc_str, ok ? "" : "  (실패 있음)");
+    }
+
+    if (srv > 0)      { kill(srv, SIGTERM);      waitpid(srv, NULL, 0); }
+    if (echo_srv > 0) { kill(echo_srv, SIGTERM); waitpid(echo_srv, NULL, 0); }
+
+    // 임시 디렉터리 정리
+    char cmd[PATH_MAX + 16];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", g_workdir);
+    if (system(cmd) != 0) fprintf(stderr, "임시 디렉터리 정리 실패: %s\n", g_workdir);
+    return 0;
+}
@@ -1,28 +1,155 @@
 #include <stdio.h>          // 표준 입출력 함수 (printf, fgets 등)
+#include <stdlib.h>         // atoi
 #include <string.h>         // 문자열 처리 함수 (strlen, strncmp, memset 등)
 #include <unistd.h>         // POSIX 시스템 호출 함수 (read, write, close)
-#include <arpa/inet.h>      // 네트워크 관련 함수 (sockaddr_in, inet_pton, htons 등)
-
-int main() {
-    // 1. 소켓 생성
-    // AF_INET : IPv4 주소 체계
-    // SOCK_STREAM : TCP (연결 지향 스트림 소켓)
-    // 0 : 프로토콜 자동 선택 (TCP로 자동 설정)
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-
-    // 2. 서버 주소 구조체 설정
-    struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;          // 주소 체계: IPv4
-    server_addr.sin_port = htons(8888);        // 포트 번호를 네트워크 바이트 순서로 변환 (big endian)
-
-    // 3. 문자열 IP 주소를 네트워크용 이진 주소로 변환
-    // 실제 서버의 IP 주소로 대체 필요 (예: "192.168.0.10")
-    inet_pton(AF_INET, "115.145.211.117", &server_addr.sin_addr);
-
-    // 4. 서버에 연결 요청 (3-way handshake)
-    connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr));
+#include <netinet/in.h>     // IPPROTO_TCP
+#include <netinet/tcp.h>    // TCP_NODELAY
+#include <time.h>           // clock_gettime, nanosleep
+
+#include "hdr_hist.h"       // 지연 시간 히스토그램
+#include "client_core.h"    // 서버 주소 / 수신 엔진 옵션과 연결
+
+// 사용법:  ./client                           (대화형 에코, 기존 동작)
+//          ./client -n 100000 -s 64           (지연 측정: 64바이트 메시지 10만 번 왕복)
+//          ./client -n 100000 -r 20000        (초당 2만 개 일정 간격으로 전송)
+//          ./client -n 100000 -w 1000         (처음 1000번은 워밍업으로 제외)
+//          ./client -n 100000 -e busypoll     (응답을 돌며 기다림: read 와 지연 비교, 엔진은 client_core.h)
+
+#define MAX_MSG (64 * 1024)
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);   // 벽시계 변경 영향 없음
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// 지연 측정 모드: size 바이트 메시지를 count 번 보내고 각 왕복 시간을 기록
+//   rate > 0 이면 1/rate 간격으로 예정 시각에 맞춰 보내고(늦었으면 바로 보냄),
+//   CO 보정의 기대 간격으로 1/rate 를 쓴다. rate == 0 이면 응답 받자마자 다음 전송(closed loop),
+//   이때 기대 간격은 원본 지연의 중앙값으로 잡는다.
+static int latency_mode(int sock, const recv_engine_t* eng, long count, int size, double rate, long warmup) {
+    static char msg[MAX_MSG], echo[MAX_MSG];
+    memset(msg, 'a', (size_t)size);      // "exit" 로 시작하지 않는 고정 메시지
+
+    int one = 1;  // 작은 메시지를 바로 내보내도록 Nagle 끄기
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    int64_t* lat = malloc((size_t)count * sizeof(int64_t));
+    hdr_hist_t raw, corrected;
+    if (!lat || hdr_init(&raw, 3600LL * 1000000000LL, 3) < 0
+             || hdr_init(&corrected, 3600LL * 1000000000LL, 3) < 0) {
+        fprintf(stderr, "메모리 부족\n");
+        return 1;
+    }
+
+    recv_stat_t st = { 0, 0 };
+    int64_t interval = rate > 0 ? (int64_t)(1e9 / rate) : 0;
+    int64_t start = now_ns(), next = start;
+    long done = 0;
+    for (long i = 0; i < warmup + count; i++) {
+        if (interval > 0) {   // 예정 시각까지 대기
+            int64_t wait = next - now_ns();
+            if (wait > 0) {
+                struct timespec ts = { wait / 1000000000LL, wait % 1000000000LL };
+                nanosleep(&ts, NULL);
+            }
+            next += interval;
+        }
+
+        int64_t t0 = now_ns();
+        if (write(sock, msg, (size_t)size) != size) {
+            perror("전송 실패");
+            break;
+        }
+        int got = 0;   // 메시지가 나뉘어 올 수 있으므로 size 바이트를 다 받을 때까지
+        while (got < size) {
+            ssize_t n = eng->fill(sock, echo + got, (size_t)(size - got), &st);
+            if (n <= 0) break;
+            got += (int)n;
+        }
+        if (got < size) {
+            printf("클라이언트: 서버 연결 끊김\n");
+            break;
+        }
+        if (i >= warmup) lat[done++] = now_ns() - t0;
+        if (i + 1 == warmup) start = now_ns();
+    }
+    double elapsed = (now_ns() - start) / 1e9;
+
+    for (long i = 0; i < done; i++) hdr_record(&raw, lat[i]);
+    if (interval == 0) interval = hdr_percentile(&raw, 50);
+    for (long i = 0; i < done; i++) hdr_record_corrected(&corrected, lat[i], interval);
+
+    printf(" 왕복 %ld회, %d 바이트, %.6f 초 (%.0f 왕복/s), 기대 간격 %.3f us\n",
+           done, size, elapsed, elapsed > 0 ? done / elapsed : 0.0, interval / 1e3);
+    printf(" 수신 방식: %s, 왕복당 수신 호출 %.2f회\n", eng->name,
+           warmup + done > 0 ? (double)st.calls / (warmup + done) : 0.0);
+    printf(" %-8s %14s %14s\n", "지연(us)", "원본", "CO 보정");
+    static const double ps[] = { 50, 90, 99, 99.9 };
+    static const char*  names[] = { "p50", "p90", "p99", "p99.9" };
+    for (int i = 0; i < 4; i++)
+        printf(" %-8s %14.3f %14.3f\n", names[i],
+               hdr_percentile(&raw, ps[i]) / 1e3, hdr_percentile(&corrected, ps[i]) / 1e3);
+    printf(" %-8s %14.3f %14.3f\n", "max", raw.max / 1e3, corrected.max / 1e3);
+    printf(" %-8s %14.3f %14.3f\n", "평균", hdr_mean(&raw) / 1e3, hdr_mean(&corrected) / 1e3);
+
+    write(sock, "exit", 4);
+    hdr_free(&raw);
+    hdr_free(&corrected);
+    free(lat);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    long   count = 0;      // -n: 지연 측정 모드 왕복 횟수 (0이면 대화형)
+    int    size = 64;      // -s: 메시지 크기
+    double rate = 0;       // -r: 초당 전송 수 (0이면 closed loop)
+    long   warmup = 0;     // -w: 워밍업 횟수
+    client_opt_t co;       // -H / -p / -e (응답은 메모리 버퍼로만 받음)
+    client_init(&co, "read", SINK_MEM);
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:r:w:" CLIENT_OPTS)) != -1) {
+        int rc = client_opt(&co, opt, optarg);
+        if (rc < 0) return 1;
+        if (rc > 0) continue;
+        switch (opt) {
+        case 'n': count  = atol(optarg); break;
+        case 's': size   = atoi(optarg); break;
+        case 'r': rate   = atof(optarg); break;
+        case 'w': warmup = atol(optarg); break;
+        default:
+            fprintf(stderr, "사용법: %s [-n 횟수 [-s 크기] [-r 초당전송] [-w 워밍업]]\n", argv[0]);
+            client_usage();
+            return 1;
+        }
+    }
+    if (co.sink != SINK_MEM) {
+        fprintf(stderr, "client 는 응답을 메모리 버퍼로만 받음 (-o mem 만 가능)\n");
+        return 1;
+    }
+    if (client_check(&co, co.eng, 1) < 0) return 1;
+    if (size < 1 || size > MAX_MSG) {
+        fprintf(stderr, "메시지 크기는 1~%d 바이트\n", MAX_MSG);
+        return 1;
+    }
+
+    // 1~4. 소켓 생성 + 서버에 연결 요청 (3-way handshake)
+    // -H / -p, 없으면 SERVER_IP / SERVER_PORT 환경변수의 서버 (예: 로컬 ./server -m echo)
+    // 이름이면 주소를 해석해 되는 쪽(IPv4/IPv6)으로 TCP 소켓을 만든다 (client_core.c)
+    int sock = client_connect(&co);
+    if (sock < 0) {
+        perror("서버 연결 실패");
+        return 1;
+    }
     printf("클라이언트: 서버에 연결됨\n");
 
+    // 지연 측정 모드 (비대화형)
+    if (count > 0) {
+        int ret = latency_mode(sock, co.eng, count, size, rate, warmup);
+        close(sock);
+        return ret;
+    }
+
     // 5. 송수신 버퍼 선언
     char send_buf[1024];    // 사용자 입력 저장용
     char recv_buf[1024];    // 서버 응답 저장용
@@ -47,7 +174,7 @@ int main() {
 
         // 서버 응답 수신
         memset(recv_buf, 0, sizeof(recv_buf));  // 이전 데이터 초기화
-        read(sock, recv_buf, sizeof(recv_buf)); // 서버로부터 응답 수신
+        read(sock, recv_buf, sizeof(recv_buf)); // 서버로부터 응답 수신 (응답 길이를 모르므로 엔진 대신 한 번 읽기)
         printf("서버 응답 > %s\n", recv_buf);    // 응답 출력
     }
 
@@ -0,0 +1,235 @@
+#define _GNU_SOURCE      // fopencookie
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include "client_core.h"
+
+#define DEFAULT_HOST  "115.145.211.117"
+#define DEFAULT_PORT  8888
+#define MEM_SINK_SIZE (4UL * 1024 * 1024)   // mem 싱크 링 버퍼 (돌려 쓰므로 요청 크기와 무관)
+
+static const char* sink_names[] = { "file", "null", "mem" };
+
+void client_init(client_opt_t* o, const char* engine, int sink) {
+    const char* ip   = getenv("SERVER_IP");   // 예: 로컬 ./server 로 벤치마크
+    const char* port = getenv("SERVER_PORT");
+    snprintf(o->host, sizeof(o->host), "%s", ip && *ip ? ip : DEFAULT_HOST);
+    o->port = port && *port ? atoi(port) : DEFAULT_PORT;
+    o->eng  = find_engine(engine);
+    o->sink = sink;
+}
+
+int client_opt(client_opt_t* o, int opt, const char* arg) {
+    switch (opt) {
+    case 'H':
+        snprintf(o->host, sizeof(o->host), "%s", arg);
+        return 1;
+    case 'p':
+        o->port = atoi(arg);
+        if (o->port <= 0 || o->port > 65535) {
+            fprintf(stderr, "잘못된 포트: %s\n", arg);
+            return -1;
+        }
+        return 1;
+    case 'e':
+        if (!(o->eng = find_engine(arg))) {
+            fprintf(stderr, "알 수 없는 엔진: %s\n", arg);
+            return -1;
+        }
+        return 1;
+    case 'o':
+        for (int i = 0; i < 3; i++)
+            if (strcmp(arg, sink_names[i]) == 0) {
+                o->sink = i;
+                return 1;
+            }
+        fprintf(stderr, "알 수 없는 싱크: %s (file|null|mem)\n", arg);
+        return -1;
+    }
+    return 0;
+}
+
+void client_usage(void) {
+    fprintf(stderr, "  공통: [-H 호스트] [-p 포트] [-e 엔진] [-o file|null|mem]\n");
+    for (int i = 0; i < recv_engine_count; i++)
+        fprintf(stderr, "  %-8s %s%s\n", recv_engines[i].name, recv_engines[i].desc,
+                recv_engines[i].fill ? "" : " [파일 전용]");
+}
+
+int client_check(const client_opt_t* o, const recv_engine_t* eng, int need_fill) {
+    if (need_fill && !eng->fill) {
+        fprintf(stderr, "%s 엔진은 사용자 버퍼로 받지 않아 이 모드에서 쓸 수 없음 (read|recv|readv|busypoll)\n",
+                eng->name);
+        return -1;
+    }
+    if (o->sink == SINK_MEM && (eng->flags & RE_NEED_FD)) {
+        fprintf(stderr, "%s 엔진은 파일 FD 로 직접 쓰므로 mem 싱크와 쓸 수 없음\n", eng->name);
+        return -1;
+    }
+    return 0;
+}
+
+int client_connect(const client_opt_t* o) {
+    char port[16];
+    snprintf(port, sizeof(port), "%d", o->port);
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;     // 이름이면 IPv4/IPv6 중 되는 쪽으로
+    hints.ai_socktype = SOCK_STREAM;
+    int rc = getaddrinfo(o->host, port, &hints, &res);
+    if (rc != 0) {
+        fprintf(stderr, "서버 주소 해석 실패 (%s): %s\n", o->host, gai_strerror(rc));
+        errno = EINVAL;
+        return -1;
+    }
+    int sock = -1;
+    for (struct addrinfo* a = res; a; a = a->ai_next) {
+        sock = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (sock < 0) continue;
+        if (connect(sock, a->ai_addr, a->ai_addrlen) == 0) break;
+        int e = errno;
+        close(sock);
+        sock = -1;
+        errno = e;
+    }
+    freeaddrinfo(res);
+    if (sock >= 0) recv_auto_forget(sock);   // 닫힌 이전 연결의 auto 탐색 결과를 물려받지 않게
+    return sock;
+}
+
+// ===== mem 싱크: 쓰기를 링 버퍼로 복사만 한다 (데이터를 사용자 메모리에 두는 비용만 남김) =====
+typedef struct {
+    char*  buf;
+    size_t at;
+} mem_sink_t;
+
+static ssize_t mem_write(void* cookie, const char* p, size_t n) {
+    mem_sink_t* m = cookie;
+    size_t left = n;
+    while (left > 0) {
+        size_t k = MEM_SINK_SIZE - m->at;
+        if (k > left) k = left;
+        memcpy(m->buf + m->at, p, k);
+        m->at = (m->at + k) % MEM_SINK_SIZE;
+        p += k;
+        left -= k;
+    }
+    return (ssize_t)n;
+}
+
+static int mem_close(void* cookie) {
+    mem_sink_t* m = cookie;
+    free(m->buf);
+    free(m);
+    return 0;
+}
+
+FILE* client_sink_open(const client_opt_t* o, const char* filename, const char* mode) {
+    FILE* fp = NULL;
+    if (o->sink == SINK_FILE) {
+        fp = fopen(filename, mode);
+    } else if (o->sink == SINK_NULL) {
+        fp = fopen("/dev/null", "wb");
+    } else {
+        mem_sink_t* m = malloc(sizeof(*m));
+        if (m && (m->buf = malloc(MEM_SINK_SIZE)) != NULL) {
+            m->at = 0;
+            cookie_io_functions_t io = { NULL, mem_write, NULL, mem_close };
+            if ((fp = fopencookie(m, "wb", io)) != NULL)
+                setvbuf(fp, NULL, _IONBF, 0);   // stdio 버퍼를 거치면 복사가 한 번 더 생김
+        }
+        if (!fp && m) {
+            free(m->buf);
+            free(m);
+        }
+        if (!fp) errno = ENOMEM;
+    }
+    if (!fp) perror("싱크 열기 실패");
+    return fp;
+}
+
+const char* client_sink_name(int sink) {
+    return sink_names[sink];
+}
+
+// ===== 파이프라인: 응답을 기다리지 않고 다음 요청을 미리 보내 왕복 대기를 겹친다 =====
+typedef struct {
+    long long mb;
+    double    sent;       // 요청 전송 시각
+    double    done;       // 마지막 바이트 수신 시각
+    double    xfer;       // 앞 응답이 끝난 뒤(또는 전송 후)부터 완료까지 = 순수 전송 시간
+    long long received;
+} pipe_req_t;
+
+static double mono_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void client_pipeline(int sock, char* line, int depth, const client_pipe_t* hook) {
+    pipe_req_t reqs[CLIENT_MAX_PIPE];
+    int n = 0;
+    for (char* tok = strtok(line, " \t"); tok; tok = strtok(NULL, " \t")) {
+        long long mb = atoll(tok);
+        if (mb <= 0 || mb > CLIENT_MAX_MB || n == CLIENT_MAX_PIPE) {
+            printf("클라이언트: 잘못된 요청 (%s)\n", tok);
+            return;
+        }
+        reqs[n++].mb = mb;
+    }
+    if (n == 0) return;
+    printf("클라이언트: %d개 요청, 최대 %d개 동시 대기\n", n, depth);
+
+    int sent = 0;
+    long long total = 0;
+    double start = mono_now(), prev_done = start;
+    for (int r = 0; r < n; r++) {
+        // 대기 중인 요청이 depth개가 되도록 채워 넣는다
+        // (개행으로 끝내야 서버가 붙어 온 요청을 나눌 수 있음: "10" "20" 이 "1020" 이 되지 않게)
+        while (sent < n && sent - r < depth) {
+            char req[64];
+            int len = hook->format ? hook->format(hook->arg, sent, reqs[sent].mb, req, sizeof(req))
+                                   : snprintf(req, sizeof(req), "%lld\n", reqs[sent].mb);
+            reqs[sent].sent = mono_now();
+            if (write(sock, req, (size_t)len) != len) {
+                perror("요청 전송 실패");
+                n = sent;
+                break;
+            }
+            if (hook->sent) hook->sent(hook->arg, sent);
+            sent++;
+        }
+        if (r >= n) break;
+
+        pipe_req_t* q = &reqs[r];
+        q->received = hook->receive(hook->arg, sock, r, q->mb);
+        q->done = mono_now();
+        q->xfer = q->done - (prev_done > q->sent ? prev_done : q->sent);
+        prev_done = q->done;
+        total += q->received;
+        if (q->received < q->mb * 1024 * 1024) {
+            printf("클라이언트: %d번째 응답이 중간에 끊김\n", r);
+            n = r + 1;
+            break;
+        }
+    }
+    double elapsed = mono_now() - start;
+
+    for (int r = 0; r < n; r++) {
+        double mb = reqs[r].received / (1024.0 * 1024.0);
+        printf("   [req %d] %lld MB  지연 %.6f 초 (전송 %.6f 초, %.2f MB/s)\n",
+               r, reqs[r].mb, reqs[r].done - reqs[r].sent,
+               reqs[r].xfer, reqs[r].xfer > 0.0 ? mb / reqs[r].xfer : 0.0);
+        if (hook->report) hook->report(hook->arg, r, reqs[r].xfer);
+    }
+    printf(" 다운로드 완료: %.2f MB (%lld 바이트)\n", total / (1024.0 * 1024.0), total);
+    printf("⏱ 소요 시간: %.6f 초\n", elapsed);
+    printf(" 평균 속도: %.2f MB/s\n", elapsed > 0.0 ? total / (1024.0 * 1024.0) / elapsed : 0.0);
+}
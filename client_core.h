@@ -0,0 +1,71 @@
+// 클라이언트 공통 부분: 서버 주소, 수신 엔진, 싱크(받은 데이터를 어디에 둘지) 선택과 연결.
+// 네 클라이언트(client, client_stream, recv_client, staticclient)가 같은 옵션과 같은 수신 코드를 써서,
+// 프로그램 차이 없이 엔진/싱크만 바꿔 같은 작업을 비교할 수 있다.
+//
+//   -H 호스트   서버 주소 (이름 또는 IP, 기본 SERVER_IP 환경변수 → 115.145.211.117)
+//   -p 포트     서버 포트 (기본 SERVER_PORT 환경변수 → 8888)
+//   -e 엔진     수신 엔진 (recv_engine.h)
+//   -o 싱크     file : received_<MB>MB.bin 에 저장
+//               null : /dev/null 에 씀 (쓰기 시스템 콜은 그대로, 디스크 없음)
+//               mem  : 메모리 링 버퍼에 복사만 (시스템 콜 없음, fileno 가 필요한 엔진은 불가)
+//
+// 파이프라인(-q 깊이)은 client_pipeline 하나를 세 클라이언트(client_stream, recv_client, staticclient)가
+// 같이 쓰고, 요청 형식/수신/요청별 추가 출력만 훅으로 바꾼다 (client_stream 의 -k 트레일러, -T 단계 기록).
+#ifndef CLIENT_CORE_H
+#define CLIENT_CORE_H
+
+#include <stdio.h>
+
+#include "recv_engine.h"
+
+#define CLIENT_OPTS "H:p:e:o:"   // 각 클라이언트의 getopt 문자열에 붙여 쓴다
+#define CLIENT_MAX_MB   (16LL * 1024 * 1024)   // 요청 크기 상한 16TB (MB 단위)
+#define CLIENT_MAX_PIPE 256                    // 파이프라인 한 줄에 넣을 수 있는 최대 요청 수
+
+enum { SINK_FILE, SINK_NULL, SINK_MEM };
+
+typedef struct {
+    char                 host[256];
+    int                  port;
+    const recv_engine_t* eng;
+    int                  sink;    // SINK_*
+} client_opt_t;
+
+// 기본값: 환경변수의 서버, engine 이름의 엔진, sink
+void client_init(client_opt_t* o, const char* engine, int sink);
+
+// getopt 결과가 공통 옵션이면 처리하고 1, 아니면 0, 값이 잘못됐으면 메시지 출력 후 -1
+int  client_opt(client_opt_t* o, int opt, const char* arg);
+
+// 공통 옵션과 엔진 목록을 stderr 에 (사용법 출력 뒤에)
+void client_usage(void);
+
+// 엔진이 싱크와 맞는지 (fill 이 필요한 클라이언트는 need_fill = 1). 맞으면 0, 아니면 메시지 출력 후 -1
+int  client_check(const client_opt_t* o, const recv_engine_t* eng, int need_fill);
+
+// 서버에 연결된 소켓 (실패 시 -1, errno 유지)
+int  client_connect(const client_opt_t* o);
+
+// 싱크 열기: file 이면 filename 을 mode 로. 실패 시 NULL (perror 출력)
+FILE* client_sink_open(const client_opt_t* o, const char* filename, const char* mode);
+
+const char* client_sink_name(int sink);
+
+// 파이프라인 훅. receive 외에는 NULL 이어도 된다 (idx = 줄 안에서 몇 번째 요청인지)
+typedef struct {
+    // 요청 문자열을 req 에 쓰고 길이 반환. 개행으로 끝나야 서버가 나눈다 (NULL 이면 "<MB>\n")
+    int       (*format)(void* arg, int idx, long long mb, char* req, size_t len);
+    // 요청을 보낸 직후
+    void      (*sent)(void* arg, int idx);
+    // 응답 하나를 받는다 (트레일러가 있으면 그것까지). 받은 바이트 수 반환, mb 보다 모자라면 거기서 중단
+    long long (*receive)(void* arg, int sock, int idx, long long mb);
+    // 요청별 결과 줄 아래에 덧붙일 출력. xfer = 그 응답의 순수 전송 시간(초)
+    void      (*report)(void* arg, int idx, double xfer);
+    void*     arg;
+} client_pipe_t;
+
+// line: 공백으로 구분된 MB 크기 목록. 요청을 최대 depth 개까지 미리 보내 두고
+// 응답은 요청 순서대로 받는다. 요청마다 지연/전송 시간, 끝에 전체 처리량을 출력
+void client_pipeline(int sock, char* line, int depth, const client_pipe_t* hook);
+
+#endif
@@ -1,102 +1,694 @@
+// build:  make
+// run  :  ./client_stream            (단일 연결, 기존 동작)
+//         ./client_stream -c 4       (4개 연결로 구간을 나눠 병렬 다운로드)
+//         ./client_stream -e splice  (수신 엔진 선택, -e all 이면 모든 엔진을 차례로 비교)
+//         ./client_stream -H 10.0.0.2 -p 8890 -e recv -o null   (서버, 엔진, 싱크 지정: client_core.h)
+//         ./client_stream -c 4 -e busypoll -o mem   (병렬 모드도 사용자 버퍼 엔진은 모두 가능)
+//         RECV_MMAP_SYNC=async ./client_stream -e mmap   (mmap 출력, 설정은 recv_mmap.c 참고)
+//         RECV_WB_DIRECT=1 ./client_stream -e wb   (수신/디스크 쓰기 스레드 분리, 설정은 recv_wb.c 참고)
+//         ./client_stream -q 4       (파이프라인: 한 줄에 "10 10 10 ..." 입력, 최대 4개 요청을 동시에 대기)
+//         ./client_stream -k         (수신하면서 CRC32C 계산, 서버(./server)가 붙인 트레일러와 비교)
+//         CRC32C_IMPL=sw ./client_stream -k   (SSE4.2 대신 소프트웨어 CRC 로 비용 비교)
+//         ./client_stream -R 10      (이어 받기: 기존 파일 길이부터 구간 요청, 끊기면 백오프 후 재연결,
+//                                     진전 없이 10번 연속 실패하면 포기. 테스트: ./server -x 30)
+//         ./client_stream -c 8 -W poisson:100,200,400,800 -S 64K:0.9,4M:0.1 -D 10
+//                                    (입력 없이 재생: 도착률 단계마다 10초씩 연결 8개에 open-loop 로 흘려
+//                                     대기/서비스 시간을 따로 잼. -W fixed:50, -W file:작업.txt 도 가능, replay.h)
+//         ./client_stream -T json    (요청마다 단계별 시각을 JSON 한 줄로 stderr 에, -T csv:phases.csv 면 파일에)
+//         입력 > 300000              (크기는 MB 단위 64비트, 최대 16TB. 1초마다 진행 상황을 stderr 로,
+//                                     PROGRESS_SEC=10 이면 10초마다, 0 이면 끔)
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
+#include <sys/resource.h>
 
-#define BLOCK_SIZE 4096  // 블록 단위로 데이터 수신
+#include "recv_engine.h"
+#include "client_core.h"
+#include "crc32c.h"
+#include "progress.h"
+#include "phase.h"
+#include "replay.h"
 
-int main() {
-    // 1. 소켓 생성
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
+#define MAX_CONN   64    // 병렬 모드 최대 연결 수
+#define MAX_MB     (16LL * 1024 * 1024)   // 요청 크기 상한 16TB (MB 단위, 64비트 계산)
+#define PROGRESS_INTERVAL 1.0             // 진행 표시 주기(초), env PROGRESS_SEC=0 이면 끔
+#define TRAILER_TIMEOUT 5 // 트레일러를 기다리는 최대 시간(초): 트레일러를 모르는 서버 대비
 
-    // 2. 서버 주소 설정
-    struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(8888);
-    inet_pton(AF_INET, "115.145.211.117", &server_addr.sin_addr);  // 서버 IP 설정
+#define BACKOFF_MIN_MS  100   // 재연결 대기: 실패할 때마다 두 배, 최대 BACKOFF_MAX_MS
+#define BACKOFF_MAX_MS  5000
 
-    // 3. 서버에 연결 요청
-    // 3. 서버에 연결 요청
-    if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("서버 연결 실패");
-        close(sock);
-        exit(1);  // 또는 return 1;
+static int g_verify = 0;  // -k: 요청에 " crc" 를 붙이고 받은 데이터를 서버 CRC32C 와 비교
+static client_opt_t g_opt;  // 서버 주소, 엔진, 싱크 (-H -p -e -o)
+
+// -T: 연결별 socket/connect 시각 (그 연결의 첫 요청 기록에 들어감)과 요청 일련번호
+static phase_t   g_conn[MAX_CONN];
+static long long g_req;
+
+// 연결 conn 으로 보낼 요청의 기록 시작: 연결 시각을 물려받는다
+static void phase_begin(phase_t* ph, int conn) {
+    *ph = g_conn[conn];
+    g_conn[conn].new_conn = 0;
+}
+
+// 서버에 연결된 소켓을 반환 (실패 시 -1). conn 번 연결의 socket/connect 시각을 남긴다
+// (-H / -p, 없으면 SERVER_IP / SERVER_PORT 환경변수의 서버)
+static int connect_server(int conn) {
+    memset(&g_conn[conn], 0, sizeof(g_conn[conn]));
+    g_conn[conn].socket_ns = phase_now();
+    int sock = client_connect(&g_opt);
+    if (sock < 0) return -1;
+    g_conn[conn].connect_ns = phase_now();
+    g_conn[conn].new_conn   = 1;
+    return sock;
+}
+
+//  경과 시간 계산  tv_sec: 초 단위, tv_nsec: 나노초 단위
+//  (CLOCK_MONOTONIC 으로 잰 값: 긴 전송 중에 벽시계가 보정되어도 흔들리지 않음)
+static double elapsed_sec(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec)
+         + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// 결과 출력 (단일/병렬 모드 공통)
+static void print_result(long long received, double elapsed) {
+    double mb_received = received / (1024.0 * 1024.0); // 받은 데이터량 (MB 단위)
+    double speed = (elapsed > 0.0) ? (mb_received / elapsed) : 0.0; //평균속도(MB/s 단위)
+
+    printf(" 다운로드 완료: %.2f MB (%lld 바이트)\n", mb_received, received);
+    printf("⏱ 소요 시간: %.6f 초\n", elapsed);
+    printf(" 평균 속도: %.2f MB/s\n", speed);
+}
+
+// 응답 뒤의 트레일러 "CRC32C xxxxxxxx\n" 에서 서버가 계산한 값을 읽는다. 없거나 형식이 다르면 -1
+static int read_trailer(int sock, uint32_t* crc) {
+    char t[CRC32C_TRAILER_LEN + 1];
+    struct timeval tmo = { TRAILER_TIMEOUT, 0 }, none = { 0, 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tmo, sizeof(tmo));
+    size_t got = 0;
+    while (got < CRC32C_TRAILER_LEN) {
+        ssize_t n = read(sock, t + got, CRC32C_TRAILER_LEN - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += (size_t)n;
+    }
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &none, sizeof(none));
+    t[got] = '\0';
+    unsigned v;
+    if (got < CRC32C_TRAILER_LEN || sscanf(t, "CRC32C %8x", &v) != 1) return -1;
+    *crc = v;
+    return 0;
+}
+
+// 검증 결과 한 줄: 계산 비용은 전송 시간 대비 비율로 (수신과 같은 패스에서 계산했으므로
+// 이 비율만큼이 체크섬 때문에 늘어난 시간의 상한이다). 일치하면 0, 아니면 -1
+static int print_verify(const char* indent, const recv_stat_t* st, int have_srv, uint32_t srv,
+                        double elapsed) {
+    if (!st->sum) {
+        printf("%sCRC32C: 이 엔진은 데이터가 사용자 공간을 거치지 않아 계산 안 함\n", indent);
+        return 0;
+    }
+    double pct = elapsed > 0.0 ? st->sum_sec / elapsed * 100.0 : 0.0;
+    if (!have_srv) {
+        printf("%sCRC32C: 0x%08x (서버 트레일러 없음, 검증 안 함) 계산 %.6f 초 = 전송 시간의 %.2f%%\n",
+               indent, st->crc, st->sum_sec, pct);
+        return 0;
+    }
+    if (st->crc != srv) {
+        printf("%sCRC32C: 불일치! 받은 데이터 0x%08x / 서버 0x%08x (파일이 손상됨)\n",
+               indent, st->crc, srv);
+        return -1;
+    }
+    printf("%sCRC32C: 0x%08x 서버와 일치 (%s, 계산 %.6f 초 = 전송 시간의 %.2f%%)\n",
+           indent, st->crc, crc32c_impl(), st->sum_sec, pct);
+    return 0;
+}
+
+// 프로세스가 지금까지 쓴 CPU 시간(user + sys, 초)
+static double cpu_sec(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1000000.0
+         + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1000000.0;
+}
+
+// 엔진별 결과 (-e all 비교표용)
+typedef struct {
+    const char* name;
+    long long   received;
+    double      elapsed;
+    double      cpu;
+    long        calls;
+} run_result_t;
+
+// 단일 연결 다운로드: 선택한 엔진으로 수신하여 파일에 저장
+static run_result_t download_single(int sock, const char* send_buf, long long mb,
+                                    const char* filename, const recv_engine_t* eng) {
+    long long size = (long long)mb * 1024 * 1024;  // 바이트 단위로 변환
+    recv_stat_t st = { 0, 0 };
+    st.sum = g_verify;
+    char req[32];
+    if (g_verify) {   // 트레일러 요청
+        snprintf(req, sizeof(req), "%lld crc", mb);
+        send_buf = req;
+    }
+    run_result_t r = { eng->name, 0, 0.0, 0.0, 0 };
+
+    // 저장할 파일(싱크) 열기
+    FILE *fp = client_sink_open(&g_opt, filename, "wb");
+    //wb(write binary) 모드로 파일 열기, 파일이 없으면 새로 생성, 있으면 덮어쓰기
+    //ab(append) 모드 기존 파일이있으면 끝에추가
+    if (!fp) return r;
+
+    // 다운로드 시간 측정 (요청 → 수신 완료까지)
+    struct timespec start, end;
+    double cpu0 = cpu_sec();
+    phase_t ph;
+    phase_begin(&ph, 0);
+    clock_gettime(CLOCK_MONOTONIC, &start);  // 요청 직전 시간 측정
+    write(sock, send_buf, strlen(send_buf)); // 요청 전송
+    ph.sent_ns  = phase_now();
+    ph.first_ns = phase_wait_first(sock);
+
+    progress_t pg;
+    progress_start(&pg, progress_counter, &st.bytes, size, PROGRESS_INTERVAL);
+    eng->run(sock, fp, size, &st);  // 블록 단위로 수신하여 파일에 저장
+    progress_stop(&pg);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);  // 다운로드 완료 시간 측정
+    ph.last_ns = phase_now();
+    ph.bytes   = st.bytes;
+    phase_emit(&ph, "client_stream", eng->name, 0, g_req++, mb, sock);
+    fclose(fp);  // 파일 닫기 (stdio 버퍼 flush 포함)
+    uint32_t srv_crc = 0;
+    int have_srv = g_verify && st.bytes == size && read_trailer(sock, &srv_crc) == 0;
+    r.cpu      = cpu_sec() - cpu0;
+    r.received = st.bytes;
+    r.elapsed  = elapsed_sec(&start, &end);
+    r.calls    = st.calls;
+
+    printf("[%s]\n", eng->name);
+    print_result(r.received, r.elapsed);
+    printf(" CPU 시간: %.6f 초 (%.3f 초/GB), 엔진 호출 %ld회\n",
+           r.cpu, r.received > 0 ? r.cpu / (r.received / (1024.0 * 1024.0 * 1024.0)) : 0.0,
+           r.calls);
+    if (g_verify) print_verify(" ", &st, have_srv, srv_crc, r.elapsed);
+    return r;
+}
+
+// -e all: 같은 요청을 엔진별로 반복해 나란히 출력
+static void print_compare(const run_result_t* rs, int n) {
+    printf(" %-8s %12s %12s %14s %12s\n", "엔진", "MB", "MB/s", "CPU(초/GB)", "호출 수");
+    for (int i = 0; i < n; i++) {
+        double mb = rs[i].received / (1024.0 * 1024.0);
+        printf(" %-8s %12.2f %12.2f %14.3f %12ld\n", rs[i].name, mb,
+               rs[i].elapsed > 0.0 ? mb / rs[i].elapsed : 0.0,
+               rs[i].received > 0 ? rs[i].cpu / (mb / 1024.0) : 0.0,
+               rs[i].calls);
+    }
+}
+
+// ===== 병렬 모드: 연결 하나가 맡는 파일 구간 =====
+typedef struct {
+    int       sock;       // 이 흐름 전용 소켓
+    int       fd;         // 공유 출력 파일 (mem 싱크면 -1: 버퍼로 받기만 함)
+    const recv_engine_t* eng;   // fill 로 받는다
+    long long mb;         // 이 흐름이 요청할 크기(MB)
+    off_t     offset;     // 파일 내 쓰기 시작 위치
+    long long received;   // 실제 수신 바이트
+    double    elapsed;    // 요청 → 마지막 바이트까지 시간(초)
+    int       conn;       // 연결 번호 (-T 기록용)
+    phase_t   ph;
+    recv_stat_t ck;       // -k: 이 구간의 CRC32C (서버도 구간 요청마다 따로 계산함)
+    int       have_srv;
+    uint32_t  srv_crc;
+} flow_t;
+
+// pwrite는 일부만 쓸 수 있으므로 끝까지 반복
+static int pwrite_all(int fd, const char* buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t w = pwrite(fd, buf, len, off);
+        if (w < 0) return -1;
+        buf += w; len -= (size_t)w; off += w;
+    }
+    return 0;
+}
+
+// 흐름 하나: 자기 구간 [offset, offset+크기) 를 "R <시작> <길이>" 로 요청하고, 받은 데이터를 그 구간에 기록
+static void* flow_worker(void* arg) {
+    flow_t* f = arg;
+    long long size = (long long)f->mb * 1024 * 1024;
+    char req[64];
+    int len = snprintf(req, sizeof(req), g_verify ? "R %lld %lld crc" : "R %lld %lld",
+                       (long long)f->offset, size);
+    char* block = malloc(f->eng->chunk);
+    struct timespec start, end;
+
+    __atomic_store_n(&f->received, 0, __ATOMIC_RELAXED);
+    if (!block) {
+        perror("수신 버퍼 할당 실패");
+        return NULL;
+    }
+    memset(&f->ck, 0, sizeof(f->ck));
+    f->ck.sum = g_verify;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    write(f->sock, req, (size_t)len);
+    f->ph.sent_ns  = phase_now();
+    f->ph.first_ns = phase_wait_first(f->sock);
+
+    while (f->received < size) {
+        size_t want = f->eng->chunk;
+        if (size - f->received < (long long)want) want = (size_t)(size - f->received);
+        ssize_t n = f->eng->fill(f->sock, block, want, &f->ck);
+        if (n <= 0) break;
+        recv_sum(&f->ck, block, (size_t)n);
+        if (f->fd >= 0 && pwrite_all(f->fd, block, (size_t)n, f->offset + f->received) < 0) {
+            perror("pwrite 실패");
+            break;
+        }
+        __atomic_store_n(&f->received, f->received + n, __ATOMIC_RELAXED);   // 진행 표시가 동시에 읽음
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    f->ph.last_ns = phase_now();
+    f->ph.bytes   = f->received;
+    f->elapsed = elapsed_sec(&start, &end);
+    f->have_srv = g_verify && f->received == size && read_trailer(f->sock, &f->srv_crc) == 0;
+    free(block);
+    return NULL;
+}
+
+// 진행 표시용: 모든 흐름이 받은 양의 합
+typedef struct {
+    flow_t* flows;
+    int     n;
+} flow_set_t;
+
+static long long flows_received(void* arg) {
+    flow_set_t* fs = arg;
+    long long sum = 0;
+    for (int i = 0; i < fs->n; i++) sum += __atomic_load_n(&fs->flows[i].received, __ATOMIC_RELAXED);
+    return sum;
+}
+
+// 병렬 다운로드: mb를 MB 단위 구간으로 나눠 nconn개 연결이 동시에 수신
+// (흐름마다 자기 구간만 구간 요청으로 받으므로 서버 데이터가 반복 패턴이 아니어도 파일이 맞다)
+static void download_parallel(const int* socks, int nconn, long long mb, const char* filename,
+                              const recv_engine_t* eng) {
+    int nflow = (mb < nconn) ? (int)mb : nconn;   // 1MB보다 잘게 나눌 수 없음
+    flow_t flows[MAX_CONN];
+    pthread_t tids[MAX_CONN];
+
+    // 흐름마다 자기 구간에 pwrite 하므로 싱크는 stdio 가 아니라 FD 로 연다
+    int fd = -1;
+    if (g_opt.sink != SINK_MEM) {
+        fd = g_opt.sink == SINK_NULL ? open("/dev/null", O_WRONLY)
+                                     : open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror("파일 열기 실패");
+            return;
+        }
+    }
+
+    // 구간 분할: 앞쪽 흐름이 나머지 1MB씩 더 맡는다
+    off_t offset = 0;
+    for (int i = 0; i < nflow; i++) {
+        flows[i].sock   = socks[i];
+        flows[i].conn   = i;
+        phase_begin(&flows[i].ph, i);
+        flows[i].fd     = fd;
+        flows[i].eng    = eng;
+        flows[i].mb     = mb / nflow + (i < mb % nflow ? 1 : 0);
+        flows[i].offset = offset;
+        offset += (off_t)flows[i].mb * 1024 * 1024;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int started[MAX_CONN];
+    for (int i = 0; i < nflow; i++) {
+        flows[i].received = 0;
+        started[i] = pthread_create(&tids[i], NULL, flow_worker, &flows[i]) == 0;
+        if (!started[i]) {   // 스레드를 못 만들면 이 흐름은 여기서 직접 받는다 (구간이 비지 않게)
+            fprintf(stderr, "흐름 %d 스레드 생성 실패, 순서대로 수신\n", i);
+            flow_worker(&flows[i]);
+        }
+    }
+    flow_set_t fs = { flows, nflow };
+    progress_t pg;
+    progress_start(&pg, flows_received, &fs, mb * 1024 * 1024, PROGRESS_INTERVAL);
+    long long received = 0;
+    for (int i = 0; i < nflow; i++) {
+        if (started[i]) pthread_join(tids[i], NULL);
+        received += flows[i].received;
+    }
+    progress_stop(&pg);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (fd >= 0) close(fd);
+
+    print_result(received, elapsed_sec(&start, &end));  // 합산 결과
+    for (int i = 0; i < nflow; i++) {
+        double fmb = flows[i].received / (1024.0 * 1024.0);
+        printf("   [flow %d] 구간 %lld~%lld: %.2f MB, %.6f 초, %.2f MB/s\n",
+               i, (long long)flows[i].offset,
+               (long long)flows[i].offset + flows[i].received,
+               fmb, flows[i].elapsed,
+               flows[i].elapsed > 0.0 ? fmb / flows[i].elapsed : 0.0);
+        if (g_verify)
+            print_verify("     ", &flows[i].ck, flows[i].have_srv, flows[i].srv_crc, flows[i].elapsed);
+        phase_emit(&flows[i].ph, "client_stream", eng->name, i, g_req++, flows[i].mb, flows[i].sock);
+    }
+    if (received < (long long)mb * 1024 * 1024)
+        printf("클라이언트: 일부 흐름이 중간에 끊김 (파일이 불완전함)\n");
+}
+
+// ===== 파이프라인 모드: 한 연결에 요청을 여러 개 미리 보내 놓고 순서대로 수신 =====
+// 보내고 받는 순서와 출력은 client_core 의 client_pipeline 이 맡고, 여기서는 훅으로
+// -k 요청 형식("<MB> crc\n")과 트레일러, -T 단계 기록만 더한다
+typedef struct {
+    recv_stat_t st;
+    int         have_srv;  // -k: 트레일러를 받았는지
+    uint32_t    srv_crc;
+    phase_t     ph;        // -T: 첫 바이트 = 앞 응답을 다 읽고 이 응답을 읽기 시작할 수 있게 된 시각
+} pipe_req_t;
+
+typedef struct {
+    const recv_engine_t* eng;
+    pipe_req_t           req[CLIENT_MAX_PIPE];
+} pipe_ctx_t;
+
+static int pipe_format(void* arg, int idx, long long mb, char* req, size_t len) {
+    (void)arg; (void)idx;
+    return snprintf(req, len, g_verify ? "%lld crc\n" : "%lld\n", mb);
+}
+
+static void pipe_sent(void* arg, int idx) {
+    pipe_ctx_t* c = arg;
+    phase_begin(&c->req[idx].ph, 0);
+    c->req[idx].ph.sent_ns = phase_now();
+}
+
+// 응답은 요청 순서대로 오므로 idx 번째 응답을 idx 번째 파일로 받는다
+static long long pipe_receive(void* arg, int sock, int idx, long long mb) {
+    pipe_ctx_t* c = arg;
+    pipe_req_t* q = &c->req[idx];
+    char filename[64];
+    snprintf(filename, sizeof(filename), "received_%lldMB_%d.bin", mb, idx);
+    FILE* fp = client_sink_open(&g_opt, filename, "wb");
+    if (!fp) return 0;
+    recv_stat_t st = { 0, 0 };
+    st.sum = g_verify;
+    progress_t pg;
+    q->ph.first_ns = phase_wait_first(sock);
+    progress_start(&pg, progress_counter, &st.bytes, mb * 1024 * 1024, PROGRESS_INTERVAL);
+    c->eng->run(sock, fp, mb * 1024 * 1024, &st);
+    progress_stop(&pg);
+    q->ph.last_ns = phase_now();
+    q->ph.bytes   = st.bytes;
+    phase_emit(&q->ph, "client_stream", c->eng->name, 0, g_req++, mb, sock);
+    fclose(fp);
+    q->st = st;
+    q->have_srv = g_verify && st.bytes == mb * 1024 * 1024 && read_trailer(sock, &q->srv_crc) == 0;
+    return st.bytes;
+}
+
+static void pipe_report(void* arg, int idx, double xfer) {
+    pipe_ctx_t* c = arg;
+    if (g_verify) print_verify("     ", &c->req[idx].st, c->req[idx].have_srv, c->req[idx].srv_crc, xfer);
+}
+
+// line: 공백으로 구분된 MB 크기 목록, depth: 동시에 대기시킬 최대 요청 수
+static void download_pipelined(int sock, char* line, int depth, const recv_engine_t* eng) {
+    static pipe_ctx_t c;   // 요청 256개분 기록이라 스택 대신
+    c.eng = eng;
+    client_pipe_t hook = { pipe_format, pipe_sent, pipe_receive, pipe_report, &c };
+    client_pipeline(sock, line, depth, &hook);
+}
+
+// ===== 재개 모드: 파일에 이미 있는 만큼은 건너뛰고 나머지 구간만 요청, 끊기면 다시 연결해 이어 받는다 =====
+// 요청은 "R <시작> <길이>" (server.c). 받은 데이터는 stdio 로 파일 끝에 이어 쓰므로
+// fwrite 로 쓰는 엔진(사용자 버퍼 엔진, auto)과 file 싱크만 쓴다.
+
+// fails 번째 연속 실패 후 대기: 지수 백오프 + 흔들기 (여러 클라이언트가 한꺼번에 다시 붙지 않게)
+static void backoff_sleep(int fails) {
+    long ms = (long)BACKOFF_MIN_MS << (fails < 8 ? fails - 1 : 7);
+    if (ms > BACKOFF_MAX_MS) ms = BACKOFF_MAX_MS;
+    ms = ms / 2 + rand() % (ms / 2 + 1);
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// *sock 이 끊기면 닫고 새로 연결한 소켓으로 바꿔 놓는다 (연결 못 하면 -1)
+static void download_resume(int* sock, long long mb, const char* filename, const recv_engine_t* eng,
+                            int retries) {
+    long long size = (long long)mb * 1024 * 1024;
+    FILE* fp = fopen(filename, "ab");   // 있으면 끝에 이어 쓰기, 없으면 새로 생성
+    if (!fp) {
+        perror("파일 열기 실패");
+        return;
+    }
+    fseeko(fp, 0, SEEK_END);
+    long long have = ftello(fp);
+    if (have > size) {   // 다른 크기로 받던 파일: 처음부터
+        printf("클라이언트: 기존 파일(%lld 바이트)이 요청보다 큼, 처음부터 받음\n", have);
+        if (!(fp = freopen(filename, "wb", fp))) {
+            perror("파일 열기 실패");
+            return;
+        }
+        have = 0;
+    }
+    if (have == size) {
+        printf("클라이언트: %s 는 이미 다 받은 파일\n", filename);
+        fclose(fp);
+        return;
+    }
+    if (have > 0) printf("클라이언트: 기존 %lld 바이트 이어 받기\n", have);
+
+    long long reused = have, fetched = 0;
+    int fails = 0, reconnects = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (have < size) {
+        if (*sock < 0) {
+            if ((*sock = connect_server(0)) < 0) {
+                if (++fails > retries) break;
+                printf("클라이언트: 재연결 실패, %d/%d번째 재시도 대기\n", fails, retries);
+                backoff_sleep(fails);
+                continue;
+            }
+            reconnects++;
+        }
+
+        char req[64];
+        snprintf(req, sizeof(req), g_verify ? "R %lld %lld crc" : "R %lld %lld", have, size - have);
+        recv_stat_t st = { 0, 0 };
+        st.sum = g_verify;
+        phase_t ph;
+        phase_begin(&ph, 0);
+        if (write(*sock, req, strlen(req)) == (ssize_t)strlen(req)) {
+            ph.sent_ns  = phase_now();
+            ph.first_ns = phase_wait_first(*sock);
+            progress_t pg;
+            progress_start(&pg, progress_counter, &st.bytes, size - have, PROGRESS_INTERVAL);
+            eng->run(*sock, fp, size - have, &st);
+            progress_stop(&pg);
+            ph.last_ns = phase_now();
+            ph.bytes   = st.bytes;
+            phase_emit(&ph, "client_stream", "resume", 0, g_req++, mb, *sock);
+        }
+        fflush(fp);   // 다음에 끊겨도 받은 데이터는 파일에 남도록
+        have    += st.bytes;
+        fetched += st.bytes;
+
+        if (have == size) {
+            if (g_verify) {   // 마지막 구간만 서버 트레일러로 검증된다
+                uint32_t srv = 0;
+                int ok = read_trailer(*sock, &srv) == 0;
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                print_verify(" 마지막 구간 ", &st, ok, srv, elapsed_sec(&start, &now));
+            }
+            break;
+        }
+
+        close(*sock);
+        *sock = -1;
+        if (st.bytes > 0) fails = 0;   // 진전이 있었으면 백오프를 처음부터
+        if (++fails > retries) break;
+        printf("클라이언트: %lld / %lld 바이트에서 연결 끊김, %d/%d번째 재시도 대기\n",
+               have, size, fails, retries);
+        backoff_sleep(fails);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    fclose(fp);
+
+    print_result(fetched, elapsed_sec(&start, &end));   // 이번에 실제로 받은 양 기준
+    printf(" 재사용 %.2f MB (이미 있던 부분), 재연결 %d회\n", reused / (1024.0 * 1024.0), reconnects);
+    if (have < size)
+        printf("클라이언트: 재시도 한도 초과, %s 는 %lld 바이트까지 (다시 실행하면 이어 받음)\n",
+               filename, have);
+}
+
+int main(int argc, char* argv[]) {
+    int nconn = 1;                                      // 연결 개수 (-c)
+    client_init(&g_opt, "read", SINK_FILE);             // 서버, 수신 엔진 (-e), 싱크 (-o)
+    int all_engines = 0;                                // -e all
+    int depth = 0;                                      // 파이프라인 깊이 (-q, 0이면 사용 안 함)
+    int retries = -1;                                   // 재개 모드 재시도 횟수 (-R, -1이면 사용 안 함)
+    const char* arrivals = NULL;                        // 재생 모드 도착 (-W, NULL 이면 대화형)
+    const char* sizes = NULL;                           // 재생 모드 크기 분포 (-S)
+    double step_sec = 10.0;                             // 재생 모드 도착률 단계당 시간 (-D)
+    int opt;
+    while ((opt = getopt(argc, argv, "c:q:kR:T:W:S:D:" CLIENT_OPTS)) != -1) {
+        int rc = 0;
+        if (opt == 'e' && strcmp(optarg, "all") == 0) {
+            all_engines = 1;
+        } else if ((rc = client_opt(&g_opt, opt, optarg)) != 0) {
+            if (rc < 0) return 1;
+        } else if (opt == 'k') {
+            g_verify = 1;
+        } else if (opt == 'T') {
+            char* path = strchr(optarg, ':');   // "json" 또는 "csv:파일"
+            if (path) *path++ = '\0';
+            if (phase_open(optarg, path) < 0) return 1;
+        } else if (opt == 'R') {
+            retries = atoi(optarg);
+            if (retries < 0) {
+                fprintf(stderr, "재시도 횟수는 0 이상이어야 함\n");
+                return 1;
+            }
+        } else if (opt == 'W') {
+            arrivals = optarg;
+        } else if (opt == 'S') {
+            sizes = optarg;
+        } else if (opt == 'D') {
+            step_sec = atof(optarg);
+        } else if (opt == 'c') {
+            nconn = atoi(optarg);
+        } else if (opt == 'q') {
+            depth = atoi(optarg);
+            if (depth < 1) {
+                fprintf(stderr, "파이프라인 깊이는 1 이상이어야 함\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "사용법: %s [-c 연결수] [-e 엔진|all] [-q 파이프라인깊이] [-k] [-R 재시도] [-T json|csv[:파일]]\n"
+                            "       [-W poisson:률,...|fixed:률,...|file:경로 [-S 크기[:비율],...] [-D 단계초]]\n", argv[0]);
+            client_usage();
+            return 1;
+        }
+    }
+    const recv_engine_t* eng = g_opt.eng;
+    if (nconn < 1 || nconn > MAX_CONN) {
+        fprintf(stderr, "연결 수는 1~%d 사이여야 함\n", MAX_CONN);
+        return 1;
+    }
+    if (nconn > 1 && (all_engines || client_check(&g_opt, eng, 1) < 0)) {
+        fprintf(stderr, "-c 는 사용자 버퍼 엔진 하나로만 사용 가능 (-e all 불가)\n");
+        return 1;
+    }
+    if (!all_engines && client_check(&g_opt, eng, 0) < 0) return 1;
+    if (depth > 0 && (nconn > 1 || all_engines)) {
+        fprintf(stderr, "-q 는 -c, -e all 과 함께 쓸 수 없음\n");
+        return 1;
+    }
+    if (retries >= 0 && (nconn > 1 || depth > 0 || all_engines || g_opt.sink != SINK_FILE ||
+                         (!eng->fill && strcmp(eng->name, "auto") != 0))) {
+        fprintf(stderr, "-R 은 단일 연결, file 싱크, 사용자 버퍼/auto 엔진에서만 사용 가능\n");
+        return 1;
+    }
+    replay_cfg_t rc;
+    if (arrivals && (depth > 0 || retries >= 0 || all_engines || g_verify ||
+                     client_check(&g_opt, eng, 1) < 0)) {
+        fprintf(stderr, "-W 는 -q, -R, -k, -e all 과 함께 쓸 수 없고 사용자 버퍼 엔진만 가능\n");
+        return 1;
+    }
+    if (arrivals && replay_parse(&rc, arrivals, sizes, step_sec) < 0) return 1;
+    if (retries >= 0) {
+        signal(SIGPIPE, SIG_IGN);   // 끊긴 연결에 요청을 써도 죽지 않고 재연결하도록
+        srand((unsigned)getpid());
     }
-    printf("클라이언트: 서버에 연결됨\n");
 
+    // 1~3. 소켓 생성 및 서버 연결 (병렬 모드면 nconn개)
+    int socks[MAX_CONN];
+    for (int i = 0; i < nconn; i++) {
+        socks[i] = connect_server(i);
+        if (socks[i] < 0) {
+            perror("서버 연결 실패");
+            while (i-- > 0) close(socks[i]);
+            exit(1);  // 또는 return 1;
+        }
+    }
+    if (nconn == 1) printf("클라이언트: 서버에 연결됨 (%s:%d, 싱크 %s)\n",
+                           g_opt.host, g_opt.port, client_sink_name(g_opt.sink));
+    else            printf("클라이언트: 서버에 %d개 연결됨 (%s:%d, 싱크 %s)\n", nconn,
+                           g_opt.host, g_opt.port, client_sink_name(g_opt.sink));
+
+    // 재생 모드: 입력 없이 작업대로 요청하고 끝낸다 (받은 데이터는 버림)
+    if (arrivals) {
+        replay_run(&rc, socks, nconn, eng, connect_server);
+        for (int i = 0; i < nconn; i++) if (socks[i] >= 0) close(socks[i]);
+        return 0;
+    }
 
     char send_buf[1024];  // 사용자 요청 입력 버퍼
 
     while (1) {
         printf("입력 > ");
-        fgets(send_buf, sizeof(send_buf), stdin);
+        if (!fgets(send_buf, sizeof(send_buf), stdin)) break;
         send_buf[strcspn(send_buf, "\n")] = '\0';  // 개행 제거
 
         if (strncmp(send_buf, "exit", 4) == 0) {
-            write(sock, send_buf, strlen(send_buf));
+            for (int i = 0; i < nconn; i++)
+                write(socks[i], send_buf, strlen(send_buf));
             break;
         }
 
+        if (depth > 0) {
+            download_pipelined(socks[0], send_buf, depth, eng);
+            continue;
+        }
+
         // 요청 크기 해석
-        int mb = atoi(send_buf);
-        if (mb <= 0 || mb > 100) {
+        long long mb = atoll(send_buf);
+        if (mb <= 0 || mb > MAX_MB) {
             printf("클라이언트: 잘못된 요청\n");
             continue;
         }
 
-        int size = mb * 1024 * 1024;  // 바이트 단위로 변환
-        char block[BLOCK_SIZE];       // 수신용 블록 버퍼
-        int received = 0;
-
-        printf("클라이언트: %d MB 요청\n", mb);
+        printf("클라이언트: %lld MB 요청\n", mb);
 
         // 4. 파일 이름 생성
         // 파일 이름은 요청 크기에 따라 다르게 설정
         char filename[64];
-        snprintf(filename, sizeof(filename), "received_%dMB.bin", mb);  // 파일
-        // 5. 저장할 파일 열기
-        FILE *fp = fopen(filename, "wb"); 
-        //wb(write binary) 모드로 파일 열기, 파일이 없으면 새로 생성, 있으면 덮어쓰기
-        //ab(append) 모드 기존 파일이있으면 끝에추가
-        if (!fp) {
-            perror("파일 열기 실패");
-            break;
-        }
+        snprintf(filename, sizeof(filename), "received_%lldMB.bin", mb);  // 파일
 
-        // 6. 다운로드 시간 측정 (요청 → 수신 완료까지)
-        struct timeval start, end;
-        gettimeofday(&start, NULL);  // 요청 직전 시간 측정
-        write(sock, send_buf, strlen(send_buf)); // 요청 전송
-
-        // 7. 블록 단위로 수신하여 파일에 저장
-        while (received < size) {
-            int n = read(sock, block, BLOCK_SIZE);
-            if (n <= 0) break;
-            fwrite(block, 1, n, fp);  // 받은 만큼만 저장
-            received += n;
+        // 5~7. 수신하여 파일에 저장하고 시간/속도 출력
+        if (retries >= 0) {
+            download_resume(&socks[0], mb, filename, eng, retries);
+        } else if (nconn > 1) {
+            download_parallel(socks, nconn, mb, filename, eng);
+        } else if (all_engines) {
+            run_result_t rs[16];
+            int n = 0;
+            for (int i = 0; i < recv_engine_count && n < 16; i++) {
+                if (g_opt.sink == SINK_MEM && (recv_engines[i].flags & RE_NEED_FD)) continue;   // 싱크와 안 맞음
+                rs[n++] = download_single(socks[0], send_buf, mb, filename, &recv_engines[i]);
+            }
+            print_compare(rs, n);
+        } else {
+            download_single(socks[0], send_buf, mb, filename, eng);
         }
-
-        gettimeofday(&end, NULL);  // 다운로드 완료 시간 측정
-        fclose(fp);  // 파일 닫기
-
-        //  경과 시간 계산  tv_sec: 초 단위, tv_usec: 마이크로초 단위
-        // 초단위와 마이크로초 단위를 합산하여 전체 경과 시간을 계산
-        double elapsed = (end.tv_sec - start.tv_sec)
-                       + (end.tv_usec - start.tv_usec) / 1000000.0;
-
-        //  평균 속도 계산
-        double mb_received = received / (1024.0 * 1024.0); // 받은 데이터량 (MB 단위)
-        double speed = mb_received / elapsed; //평균속도(MB/s 단위)
-
-        //  결과 출력
-        printf(" 다운로드 완료: %.2f MB (%d 바이트)\n", mb_received, received);
-        printf("⏱ 소요 시간: %.6f 초\n", elapsed);
-        printf(" 평균 속도: %.2f MB/s\n", speed);
     }
 
-    close(sock);  // 소켓 종료
+    for (int i = 0; i < nconn; i++) close(socks[i]);  // 소켓 종료
     return 0;
 }
@@ -0,0 +1,116 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc32c.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define CRC32C_X86 1
+#endif
+
+#define POLY  0x82f63b78u   // Castagnoli 다항식 (비트 반전 표현)
+#define LANE  256           // 하드웨어 경로에서 세 갈래로 나눠 동시에 계산하는 구간 길이
+
+static uint32_t    T[8][256];   // slicing-by-8 표
+static uint32_t    Z[4][256];   // "LANE 바이트의 0 을 더 넣은 효과" (레지스터 값에 대해 선형이라 바이트별 표로 충분)
+static int         g_hw;
+static const char* g_impl = "sw";
+
+static uint32_t crc_sw(uint32_t c, const uint8_t* p, size_t n);
+
+// 표 생성과 구현 선택은 main 전에 한 번 (server 의 연결 스레드들이 동시에 불러도 안전)
+__attribute__((constructor))
+static void crc32c_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = c & 1 ? (c >> 1) ^ POLY : c >> 1;
+        T[0][i] = c;
+    }
+    for (int t = 1; t < 8; t++)
+        for (int i = 0; i < 256; i++)
+            T[t][i] = (T[t - 1][i] >> 8) ^ T[0][T[t - 1][i] & 0xff];
+
+    static const uint8_t zeros[LANE];
+    for (int b = 0; b < 4; b++)
+        for (uint32_t v = 0; v < 256; v++)
+            Z[b][v] = crc_sw(v << (8 * b), zeros, LANE);
+
+#ifdef CRC32C_X86
+    const char* env = getenv("CRC32C_IMPL");
+    if (__builtin_cpu_supports("sse4.2") && !(env && strcmp(env, "sw") == 0)) {
+        g_hw   = 1;
+        g_impl = "sse4.2";
+    }
+#endif
+}
+
+// 소프트웨어: 8바이트씩 표 8개로 (바이트 단위 표보다 4~5배 빠름)
+static uint32_t crc_sw(uint32_t c, const uint8_t* p, size_t n) {
+    while (n && ((uintptr_t)p & 7)) {
+        c = (c >> 8) ^ T[0][(c ^ *p++) & 0xff];
+        n--;
+    }
+    while (n >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        w ^= c;
+        c = T[7][w & 0xff]         ^ T[6][(w >> 8) & 0xff]  ^
+            T[5][(w >> 16) & 0xff] ^ T[4][(w >> 24) & 0xff] ^
+            T[3][(w >> 32) & 0xff] ^ T[2][(w >> 40) & 0xff] ^
+            T[1][(w >> 48) & 0xff] ^ T[0][w >> 56];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) c = (c >> 8) ^ T[0][(c ^ *p++) & 0xff];
+    return c;
+}
+
+#ifdef CRC32C_X86
+// 레지스터 c 뒤에 LANE 바이트가 더 이어졌을 때 c 의 몫
+static inline uint32_t shift_lane(uint32_t c) {
+    return Z[0][c & 0xff] ^ Z[1][(c >> 8) & 0xff] ^ Z[2][(c >> 16) & 0xff] ^ Z[3][c >> 24];
+}
+
+// SSE4.2 crc32 명령. 명령 하나의 지연이 3사이클이라 한 줄로 이어 계산하면 1/3 성능만 나오므로,
+// 3*LANE 바이트씩 세 구간을 동시에 계산하고 shift_lane 으로 합친다.
+// 컴파일 옵션과 상관없이 이 함수만 SSE4.2 로 만든다
+__attribute__((target("sse4.2")))
+static uint32_t crc_hw(uint32_t c, const uint8_t* p, size_t n) {
+    while (n && ((uintptr_t)p & 7)) {
+        c = _mm_crc32_u8(c, *p++);
+        n--;
+    }
+    uint64_t c64 = c;
+    while (n >= 3 * LANE) {
+        uint64_t a = c64, b = 0, d = 0;
+        for (size_t i = 0; i < LANE; i += 8) {
+            a = _mm_crc32_u64(a, *(const uint64_t*)(p + i));
+            b = _mm_crc32_u64(b, *(const uint64_t*)(p + LANE + i));
+            d = _mm_crc32_u64(d, *(const uint64_t*)(p + 2 * LANE + i));
+        }
+        c64 = shift_lane(shift_lane((uint32_t)a) ^ (uint32_t)b) ^ (uint32_t)d;
+        p += 3 * LANE;
+        n -= 3 * LANE;
+    }
+    while (n >= 8) {
+        c64 = _mm_crc32_u64(c64, *(const uint64_t*)p);
+        p += 8;
+        n -= 8;
+    }
+    c = (uint32_t)c64;
+    while (n--) c = _mm_crc32_u8(c, *p++);
+    return c;
+}
+#endif
+
+uint32_t crc32c_update(uint32_t crc, const void* buf, size_t n) {
+    uint32_t c = ~crc;
+#ifdef CRC32C_X86
+    if (g_hw) return ~crc_hw(c, buf, n);
+#endif
+    return ~crc_sw(c, buf, n);
+}
+
+const char* crc32c_impl(void) {
+    return g_impl;
+}
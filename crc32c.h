@@ -0,0 +1,19 @@
+// CRC32C (Castagnoli) 스트리밍 체크섬: 수신하면서 블록마다 이어서 계산한다.
+// x86 에서 SSE4.2 crc32 명령을 쓸 수 있으면 그것으로, 아니면 slicing-by-8 표로 계산.
+// (client_stream 수신 엔진과 server 의 전송 검증 트레일러가 같이 씀)
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 서버가 응답 뒤에 붙이는 트레일러: "CRC32C xxxxxxxx\n" (항상 16바이트)
+#define CRC32C_TRAILER_LEN 16
+
+// crc 에 buf[0..n) 를 이어서 계산한 값 (처음엔 crc = 0). zlib 의 crc32() 와 같은 사용법
+uint32_t    crc32c_update(uint32_t crc, const void* buf, size_t n);
+
+// 선택된 구현 이름 ("sse4.2" | "sw"). env CRC32C_IMPL=sw 로 소프트웨어 구현 강제 가능
+const char* crc32c_impl(void);
+
+#endif
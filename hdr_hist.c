@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "hdr_hist.h"
+
+// 값 v 가 속한 버킷(2의 거듭제곱 구간)
+static int32_t bucket_index(const hdr_hist_t* h, int64_t v) {
+    int32_t pow2ceiling = 64 - __builtin_clzll((uint64_t)(v | h->sub_bucket_mask));
+    return pow2ceiling - (h->sub_bucket_half_count_magnitude + 1);
+}
+
+static int32_t counts_index(const hdr_hist_t* h, int64_t v) {
+    int32_t b   = bucket_index(h, v);
+    int32_t sub = (int32_t)(v >> b);
+    return ((b + 1) << h->sub_bucket_half_count_magnitude) + (sub - h->sub_bucket_half_count);
+}
+
+// 인덱스가 나타내는 구간의 가장 작은 값
+static int64_t value_at(const hdr_hist_t* h, int32_t idx) {
+    int32_t b   = (idx >> h->sub_bucket_half_count_magnitude) - 1;
+    int32_t sub = (idx & (h->sub_bucket_half_count - 1)) + h->sub_bucket_half_count;
+    if (b < 0) {
+        sub -= h->sub_bucket_half_count;
+        b = 0;
+    }
+    return (int64_t)sub << b;
+}
+
+// v 와 같은 칸으로 취급되는 가장 큰 값
+static int64_t highest_equivalent(const hdr_hist_t* h, int64_t v) {
+    int32_t b   = bucket_index(h, v);
+    int32_t sub = (int32_t)(v >> b);
+    if (sub >= h->sub_bucket_count) b++;
+    return value_at(h, counts_index(h, v)) + ((int64_t)1 << b) - 1;
+}
+
+int hdr_init(hdr_hist_t* h, int64_t highest, int sig_figs) {
+    memset(h, 0, sizeof(*h));
+    if (highest < 2 || sig_figs < 1 || sig_figs > 5) return -1;
+
+    // 유효숫자 sig_figs 자리를 보장하는 하위 버킷 수 (2의 거듭제곱)
+    int64_t single_unit = 2;
+    for (int i = 0; i < sig_figs; i++) single_unit *= 10;
+    int32_t mag = 0;
+    while (((int64_t)1 << mag) < single_unit) mag++;
+    h->sub_bucket_half_count_magnitude = (mag > 1 ? mag : 1) - 1;
+    h->sub_bucket_count      = 1 << (h->sub_bucket_half_count_magnitude + 1);
+    h->sub_bucket_half_count = h->sub_bucket_count / 2;
+    h->sub_bucket_mask       = (int64_t)h->sub_bucket_count - 1;
+
+    // highest 를 담을 때까지 버킷(2배씩) 추가
+    int64_t smallest_untrackable = h->sub_bucket_count;
+    int32_t buckets = 1;
+    while (smallest_untrackable <= highest) {
+        if (smallest_untrackable > INT64_MAX / 2) { buckets++; break; }
+        smallest_untrackable <<= 1;
+        buckets++;
+    }
+    h->bucket_count = buckets;
+    h->counts_len   = (buckets + 1) * h->sub_bucket_half_count;
+    h->highest      = highest;
+    h->min          = INT64_MAX;
+    h->counts       = calloc((size_t)h->counts_len, sizeof(int64_t));
+    return h->counts ? 0 : -1;
+}
+
+void hdr_free(hdr_hist_t* h) {
+    free(h->counts);
+    h->counts = NULL;
+}
+
+void hdr_record(hdr_hist_t* h, int64_t v) {
+    if (v < 0) v = 0;
+    if (v > h->highest) v = h->highest;
+    h->counts[counts_index(h, v)]++;
+    h->total++;
+    h->sum += (double)v;
+    if (v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+}
+
+void hdr_record_corrected(hdr_hist_t* h, int64_t v, int64_t expected_interval) {
+    hdr_record(h, v);
+    if (expected_interval <= 0) return;
+    for (int64_t missing = v - expected_interval; missing >= expected_interval;
+         missing -= expected_interval)
+        hdr_record(h, missing);
+}
+
+void hdr_reset(hdr_hist_t* h) {
+    memset(h->counts, 0, (size_t)h->counts_len * sizeof(int64_t));
+    h->total = 0;
+    h->sum   = 0.0;
+    h->min   = INT64_MAX;
+    h->max   = 0;
+}
+
+void hdr_add(hdr_hist_t* dst, const hdr_hist_t* src) {
+    for (int32_t i = 0; i < src->counts_len; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    dst->sum   += src->sum;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+int64_t hdr_percentile(const hdr_hist_t* h, double p) {
+    if (h->total == 0) return 0;
+    if (p > 100.0) p = 100.0;
+    int64_t target = (int64_t)(p / 100.0 * (double)h->total + 0.5);
+    if (target < 1) target = 1;
+    int64_t seen = 0;
+    for (int32_t i = 0; i < h->counts_len; i++) {
+        seen += h->counts[i];
+        if (seen >= target) {
+            int64_t v = highest_equivalent(h, value_at(h, i));
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+double hdr_mean(const hdr_hist_t* h) {
+    return h->total ? h->sum / (double)h->total : 0.0;
+}
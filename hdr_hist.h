@@ -0,0 +1,39 @@
+// HDR(High Dynamic Range) 히스토그램: 1 ~ highest 범위의 값을 유효숫자 sig_figs 자리 정밀도로
+// 고정 메모리에 기록한다. 지연 시간(나노초) 꼬리 분포 측정용.
+#ifndef HDR_HIST_H
+#define HDR_HIST_H
+
+#include <stdint.h>
+
+typedef struct {
+    int64_t  highest;            // 기록 가능한 최대값 (넘으면 이 값으로 기록)
+    int32_t  sub_bucket_half_count_magnitude;
+    int32_t  sub_bucket_count;
+    int32_t  sub_bucket_half_count;
+    int64_t  sub_bucket_mask;
+    int32_t  bucket_count;
+    int32_t  counts_len;
+    int64_t  total;              // 기록된 값 개수
+    int64_t  min, max;
+    double   sum;                // 평균 계산용
+    int64_t* counts;
+} hdr_hist_t;
+
+// 성공 0, 실패 -1
+int     hdr_init(hdr_hist_t* h, int64_t highest, int sig_figs);
+void    hdr_free(hdr_hist_t* h);
+void    hdr_record(hdr_hist_t* h, int64_t v);
+
+// Coordinated Omission 보정 기록: v 가 기대 간격보다 길면, 그 사이에 보냈어야 할 요청들이
+// 겪었을 지연(v - interval, v - 2*interval, ...)도 함께 기록한다
+void    hdr_record_corrected(hdr_hist_t* h, int64_t v, int64_t expected_interval);
+
+// 모두 지우기 (메모리는 그대로)
+void    hdr_reset(hdr_hist_t* h);
+// src 를 dst 에 합친다 (스레드별로 따로 기록한 것을 모을 때). 둘은 같은 highest/sig_figs 로 만든 것
+void    hdr_add(hdr_hist_t* dst, const hdr_hist_t* src);
+
+int64_t hdr_percentile(const hdr_hist_t* h, double p);   // p: 0 ~ 100
+double  hdr_mean(const hdr_hist_t* h);
+
+#endif
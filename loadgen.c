@@ -0,0 +1,331 @@
+// build:  make loadgen
+// run  :  ./loadgen -n 10000 -c 2000 -s 1          (1MB 다운로드 세션 1만 개, 동시 2000개)
+//         ./loadgen -h 127.0.0.1 -p 8888 -t 4      (서버 주소, 이벤트 루프(스레드) 수 지정)
+//         ./loadgen -i 5                           (5초 동안 진행이 없는 세션은 실패로 끊음, 기본 10초)
+//
+// client_stream 과 같은 프로토콜(ASCII MB 수 → N MB 원시 데이터)을 쓰는 부하 생성기.
+// 논블로킹 소켓 + epoll, CPU 코어마다 이벤트 루프 하나씩 두고 세션을 나눠 맡는다.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+#define RECV_BUF   (64 * 1024)  // 루프마다 공유하는 수신 버퍼 (데이터는 버림)
+#define MAX_EVENTS 1024
+#define MAX_MB     (16LL * 1024 * 1024)   // 세션당 요청 크기 상한 16TB (MB 단위, 클라이언트와 같음)
+
+// ===== 설정 =====
+static char g_host[64]  = "115.145.211.117";
+static int  g_port      = 8888;
+static long g_sessions  = 1000;   // 전체 세션 수 (-n)
+static int  g_conc      = 100;    // 동시 세션 수 (-c)
+static long long g_mb   = 1;      // 세션당 요청 크기 (-s, MB)
+static int  g_threads   = 0;      // 이벤트 루프 수 (-t, 0이면 코어 수)
+static int  g_idle      = 10;     // 세션 무진행 한도 초 (-i): 멈춘 서버/연결 때문에 끝나지 않는 일이 없게
+static struct sockaddr_in g_addr;
+
+// ===== 세션 하나 = 연결 1개 + 요청 1개 =====
+enum { S_CONNECTING, S_RECEIVING };
+
+typedef struct {
+    int       fd;
+    int       state;
+    long long remain;     // 남은 수신 바이트
+    double    t_start;    // connect 시작 시각
+    double    t_active;   // 마지막으로 진행(연결 완료/수신)이 있었던 시각
+} session_t;
+
+// ===== 이벤트 루프(스레드)별 상태 =====
+typedef struct {
+    int        id;
+    int        ep;          // epoll FD
+    long       todo;        // 이 루프가 시작할 세션 수
+    long       started;
+    long       done;        // 정상 완료 세션 수
+    long       failed;      // 연결/수신 실패 세션 수 (시간 초과 포함)
+    long       timeouts;    // 그중 -i 동안 진행이 없어 끊은 세션 수
+    int        conc;        // 이 루프의 동시 세션 수
+    long long  bytes;       // 누적 수신 바이트
+    double*    lat;         // 세션 완료 시간(초) 기록
+    session_t* pool;        // conc개 세션 슬롯
+} loop_t;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 새 세션 시작: 논블로킹 connect 후 쓰기 가능 이벤트를 기다린다
+// 실패해도 시도는 센다: FD 가 바닥나(EMFILE/ENFILE) socket() 이 계속 실패해도 재시도 루프가 끝나도록
+static int session_start(loop_t* L, session_t* s) {
+    L->started++;
+    s->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (s->fd < 0) return -1;
+    s->state   = S_CONNECTING;
+    s->remain  = g_mb * 1024 * 1024;
+    s->t_start = s->t_active = now_s();
+
+    if (connect(s->fd, (struct sockaddr*)&g_addr, sizeof(g_addr)) < 0 && errno != EINPROGRESS) {
+        close(s->fd);
+        s->fd = -1;
+        return -1;
+    }
+    struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = s };
+    if (epoll_ctl(L->ep, EPOLL_CTL_ADD, s->fd, &ev) < 0) {
+        close(s->fd);
+        s->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+// 세션 종료 후 남은 일이 있으면 같은 슬롯으로 다음 세션 시작
+static void session_end(loop_t* L, session_t* s, int ok) {
+    if (ok) {
+        L->lat[L->done++] = now_s() - s->t_start;
+        (void)write(s->fd, "exit", 4);  // 서버에 종료 알림
+    } else {
+        L->failed++;
+    }
+    close(s->fd);  // epoll 에서도 자동 제거
+    s->fd = -1;
+
+    while (L->started < L->todo) {
+        if (session_start(L, s) == 0) return;
+        L->failed++;
+    }
+}
+
+// 연결 완료 → 요청 전송 → 수신 대기로 전환
+static void on_writable(loop_t* L, session_t* s) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(s->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+        session_end(L, s, 0);
+        return;
+    }
+    char req[32];
+    int n = snprintf(req, sizeof(req), "%lld\n", g_mb);
+    if (write(s->fd, req, (size_t)n) != n) {   // 요청은 작아서 한 번에 들어간다
+        session_end(L, s, 0);
+        return;
+    }
+    s->state    = S_RECEIVING;
+    s->t_active = now_s();
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = s };
+    epoll_ctl(L->ep, EPOLL_CTL_MOD, s->fd, &ev);
+}
+
+// 읽을 수 있는 만큼 읽고 버린다 (EAGAIN이면 다음 이벤트까지 대기)
+static void on_readable(loop_t* L, session_t* s, char* buf) {
+    while (s->remain > 0) {
+        size_t want = RECV_BUF;
+        if (s->remain < (long long)want) want = (size_t)s->remain;
+        ssize_t n = read(s->fd, buf, want);
+        if (n > 0) {
+            s->remain -= n;
+            L->bytes  += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            s->t_active = now_s();
+            return;
+        }
+        session_end(L, s, 0);   // EOF 또는 오류: 중간에 끊김
+        return;
+    }
+    session_end(L, s, 1);
+}
+
+// g_idle 초 넘게 진행이 없는 세션을 실패로 끊는다 (슬롯은 다음 세션에 넘어감)
+static void reap_idle(loop_t* L, double now) {
+    for (int i = 0; i < L->conc; i++) {
+        session_t* s = &L->pool[i];
+        if (s->fd >= 0 && now - s->t_active > g_idle) {
+            L->timeouts++;
+            session_end(L, s, 0);
+        }
+    }
+}
+
+static void* loop_main(void* arg) {
+    loop_t* L = arg;
+
+    // 루프 하나당 코어 하나 (코어 수보다 루프가 많으면 돌려가며 배치)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(L->id % (int)sysconf(_SC_NPROCESSORS_ONLN), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    char* buf = malloc(RECV_BUF);
+    struct epoll_event evs[MAX_EVENTS];
+
+    for (int i = 0; i < L->conc; i++) {
+        L->pool[i].fd = -1;
+        while (L->started < L->todo) {
+            if (session_start(L, &L->pool[i]) == 0) break;
+            L->failed++;
+        }
+    }
+
+    double last_reap = now_s();
+    while (L->done + L->failed < L->todo) {
+        int n = epoll_wait(L->ep, evs, MAX_EVENTS, 1000);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            session_t* s = evs[i].data.ptr;
+            if (s->fd < 0) continue;
+            if (s->state == S_CONNECTING) on_writable(L, s);
+            else                          on_readable(L, s, buf);
+        }
+        double now = now_s();
+        if (now - last_reap >= 1.0) {   // 세션 전체 검사는 1초에 한 번만
+            reap_idle(L, now);
+            last_reap = now;
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// 정렬된 배열에서 p 백분위 값
+static double percentile(const double* v, long n, double p) {
+    if (n == 0) return 0.0;
+    long i = (long)(p / 100.0 * (n - 1) + 0.5);
+    return v[i];
+}
+
+// 수천 개 연결을 위해 FD 한도를 하드 한도까지 올린다
+static void raise_nofile(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:n:c:s:t:i:")) != -1) {
+        switch (opt) {
+        case 'h': snprintf(g_host, sizeof(g_host), "%s", optarg); break;
+        case 'p': g_port     = atoi(optarg); break;
+        case 'n': g_sessions = atol(optarg); break;
+        case 'c': g_conc     = atoi(optarg); break;
+        case 's': g_mb       = atoll(optarg); break;
+        case 't': g_threads  = atoi(optarg); break;
+        case 'i': g_idle     = atoi(optarg); break;
+        default:
+            fprintf(stderr, "사용법: %s [-h 호스트] [-p 포트] [-n 세션수] [-c 동시세션] [-s MB] [-t 루프수] [-i 무진행초]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (g_threads <= 0) g_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (g_sessions < 1 || g_conc < 1 || g_mb < 1 || g_mb > MAX_MB || g_idle < 1) {
+        fprintf(stderr, "잘못된 설정\n");
+        return 1;
+    }
+    if (g_conc > g_sessions) g_conc = (int)g_sessions;
+    if (g_threads > g_conc)  g_threads = g_conc;
+
+    memset(&g_addr, 0, sizeof(g_addr));
+    g_addr.sin_family = AF_INET;
+    g_addr.sin_port   = htons((uint16_t)g_port);
+    if (inet_pton(AF_INET, g_host, &g_addr.sin_addr) != 1) {
+        fprintf(stderr, "잘못된 주소: %s\n", g_host);
+        return 1;
+    }
+    raise_nofile();
+
+    printf("loadgen: %s:%d  세션 %ld개 × %lld MB, 동시 %d, 루프 %d개\n",
+           g_host, g_port, g_sessions, g_mb, g_conc, g_threads);
+
+    // 세션과 동시성을 루프마다 고르게 나눈다
+    loop_t*    loops = calloc((size_t)g_threads, sizeof(loop_t));
+    pthread_t* tids  = calloc((size_t)g_threads, sizeof(pthread_t));
+    for (int i = 0; i < g_threads; i++) {
+        loop_t* L = &loops[i];
+        L->id   = i;
+        L->ep   = epoll_create1(0);
+        if (L->ep < 0) {
+            perror("epoll_create1 실패");
+            return 1;
+        }
+        L->todo = g_sessions / g_threads + (i < g_sessions % g_threads ? 1 : 0);
+        L->conc = g_conc / g_threads + (i < g_conc % g_threads ? 1 : 0);
+        L->lat  = malloc((size_t)L->todo * sizeof(double));
+        L->pool = calloc((size_t)L->conc, sizeof(session_t));
+    }
+
+    double t0 = now_s();
+    int started[g_threads];
+    for (int i = 0; i < g_threads; i++) {
+        started[i] = pthread_create(&tids[i], NULL, loop_main, &loops[i]) == 0;
+        if (!started[i]) {   // 스레드를 못 만들면 그 루프의 세션은 여기서 직접 돌린다
+            fprintf(stderr, "루프 %d 스레드 생성 실패, 순서대로 실행\n", i);
+            loop_main(&loops[i]);
+        }
+    }
+    for (int i = 0; i < g_threads; i++)
+        if (started[i]) pthread_join(tids[i], NULL);
+    double elapsed = now_s() - t0;
+
+    // 집계
+    long done = 0, failed = 0, timeouts = 0;
+    long long bytes = 0;
+    for (int i = 0; i < g_threads; i++) {
+        done     += loops[i].done;
+        failed   += loops[i].failed;
+        timeouts += loops[i].timeouts;
+        bytes    += loops[i].bytes;
+    }
+    double* lat = malloc((size_t)(done > 0 ? done : 1) * sizeof(double));
+    long k = 0;
+    for (int i = 0; i < g_threads; i++) {
+        memcpy(lat + k, loops[i].lat, (size_t)loops[i].done * sizeof(double));
+        k += loops[i].done;
+    }
+    qsort(lat, (size_t)done, sizeof(double), cmp_double);
+
+    double mb = bytes / (1024.0 * 1024.0);
+    printf(" 완료 세션: %ld (실패 %ld, 그중 %d초 무진행 %ld)\n", done, failed, g_idle, timeouts);
+    printf("⏱ 소요 시간: %.6f 초\n", elapsed);
+    printf(" 합계 속도: %.2f MB/s (%.2f MB)\n", elapsed > 0 ? mb / elapsed : 0.0, mb);
+    printf(" 연결 속도: %.1f conn/s\n", elapsed > 0 ? done / elapsed : 0.0);
+    printf(" 세션 완료 시간(ms): p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f max=%.3f\n",
+           percentile(lat, done, 50) * 1e3, percentile(lat, done, 90) * 1e3,
+           percentile(lat, done, 99) * 1e3, percentile(lat, done, 99.9) * 1e3,
+           done ? lat[done - 1] * 1e3 : 0.0);
+
+    for (int i = 0; i < g_threads; i++) {
+        close(loops[i].ep);
+        free(loops[i].lat);
+        free(loops[i].pool);
+    }
+    free(lat);
+    free(loops);
+    free(tids);
+    return failed ? 1 : 0;
+}
@@ -1,3 +1,12 @@
+// build:  make myread.so
+// run  :  LD_PRELOAD=./myread.so ./client_stream
+// env  :  MYREAD_PATTERNS="Z,ABC,\x00\xff"  // 찾을 바이트열 (쉼표 구분, \xNN \, \\ 이스케이프, 기본 "Z")
+//         MYREAD_MAX_REPORTS=16             // FD마다 위치를 출력할 최대 일치 수 (그 뒤로는 개수만 셈)
+//         MYREAD_IMPL=auto|avx2|sse2|memchr // 스캐너 구현 (기본 auto: 패턴 하나면 memchr, 여럿이면 avx2/sse2)
+//
+// read 로 들어오는 데이터를 FD별 스트림으로 보고 패턴을 찾는다 (pscan.c).
+// 두 read 에 걸친 일치도 찾고, 위치는 그 FD에서 지금까지 읽은 바이트 기준 절대 위치로 보고한다.
+// close 할 때(또는 종료 시) FD별 요약을 출력하고 상태를 비운다.
 #ifdef RUNTIME
 #define _GNU_SOURCE
 #include <stdio.h>
@@ -6,49 +15,104 @@
 #include <unistd.h>
 #include <string.h>
 
-/* read wrapper function */
-ssize_t read(int fd, void *buf, size_t count)
-{
-    // 원래 read 함수의 주소를 담을 함수 포인터
-    ssize_t (*readp)(int, void *, size_t);
-    char *error;
+#include "pscan.h"
 
-    // 상태 저장 변수
-    static int z_detected = 0;   // Z를 한 번이라도 감지했는가?
-    static int z_not_found_printed = 0; // Z 없음 출력 했는가?
+#define MAX_FD 4096   // 상태를 두는 FD 범위 (이보다 큰 FD는 검사하지 않음)
 
-    // 실제 read 주소 획득
-    readp = dlsym(RTLD_NEXT, "read");
+typedef struct {
+    pscan_stream_t st;
+    uint64_t       count[PSCAN_MAX_PATTERNS];   // 패턴별 일치 수
+    uint64_t       total;                       // 전체 일치 수
+    int            fd;
+} fd_scan_t;
+
+static ssize_t (*readp)(int, void*, size_t);
+static int     (*closep)(int);
+static pscan_t   g_ps;
+static int       g_ready;
+static uint64_t  g_max_reports = 16;
+static fd_scan_t S[MAX_FD];
+
+static void on_match(void* arg, int pat, uint64_t off) {
+    fd_scan_t* f = arg;
+    f->count[pat]++;
+    if (f->total++ < g_max_reports)
+        fprintf(stderr, "[interpose] fd=%d 패턴 \"%s\" 위치 %llu\n",
+                f->fd, g_ps.text[pat], (unsigned long long)off);
+    else if (f->total == g_max_reports + 1)
+        fprintf(stderr, "[interpose] fd=%d 일치가 많아 이후 위치는 생략 (종료 시 개수만 출력)\n", f->fd);
+}
+
+// FD 하나의 요약 출력 후 상태 비우기
+static void finish_fd(int fd) {
+    fd_scan_t* f = &S[fd];
+    if (f->st.pos == 0) return;
+    char line[1024];
+    int n = snprintf(line, sizeof(line), "[interpose] fd=%d 요약: %llu 바이트 검사,",
+                     fd, (unsigned long long)f->st.pos);
+    for (int k = 0; k < g_ps.n && n < (int)sizeof(line); k++)
+        n += snprintf(line + n, sizeof(line) - n, " \"%s\" %llu회", g_ps.text[k],
+                      (unsigned long long)f->count[k]);
+    fprintf(stderr, "%s\n", line);
+    memset(f, 0, sizeof(*f));
+}
+
+__attribute__((constructor))
+static void init(void) {
+    char* error;
+    readp = dlsym(RTLD_NEXT, "read");   // 원래 read 주소는 한 번만 얻는다
     if ((error = dlerror()) != NULL) {
         fputs(error, stderr);
         exit(1);
     }
+    closep = dlsym(RTLD_NEXT, "close");
+
+    const char* pats = getenv("MYREAD_PATTERNS");
+    if (pscan_init(&g_ps, pats && *pats ? pats : "Z") < 0) {
+        fprintf(stderr, "[interpose] MYREAD_PATTERNS 해석 실패, 검사 끔\n");
+        return;
+    }
+    const char* impl = getenv("MYREAD_IMPL");
+    if (impl && *impl && pscan_set_impl(&g_ps, impl) < 0)
+        fprintf(stderr, "[interpose] MYREAD_IMPL=%s 지원 안 함, %s 사용\n", impl, g_ps.impl);
+    const char* mr = getenv("MYREAD_MAX_REPORTS");
+    if (mr && *mr) g_max_reports = strtoull(mr, NULL, 10);
+
+    fprintf(stderr, "[interpose] 패턴 %d개 (", g_ps.n);
+    for (int k = 0; k < g_ps.n; k++) fprintf(stderr, "%s\"%s\"", k ? ", " : "", g_ps.text[k]);
+    fprintf(stderr, "), 스캐너 %s\n", g_ps.impl);
+    g_ready = 1;
+}
+
+__attribute__((destructor))
+static void fini(void) {
+    if (!g_ready) return;
+    for (int fd = 0; fd < MAX_FD; fd++) finish_fd(fd);
+}
+
+/* read wrapper function */
+ssize_t read(int fd, void *buf, size_t count)
+{
+    if (!readp) readp = dlsym(RTLD_NEXT, "read");   // 생성자보다 먼저 불린 경우
 
     // read 호출
     ssize_t n = readp(fd, buf, count);
 
-    // 읽은 데이터가 있을 경우 검사
-    if (n > 0) {
-        char *p = memchr(buf, 'Z', n);
-
-        if (p && !z_detected) {
-            // 처음으로 Z를 발견한 경우에만 출력
-            fprintf(stderr, "[interpose] read(fd=%d, count=%zu) → %zd bytes: 'Z' 최초 감지!\n", fd, count, n);
-            char *end = (char *)buf + n;
-            while (p && p < end) {
-                fprintf(stderr, "  → 'Z' 위치: %p (오프셋: %ld)\n", p, p - (char *)buf);
-                p = memchr(p + 1, 'Z', end - p - 1);
-            }
-            z_detected = 1;  // 이후에는 감지해도 출력하지 않음
-        }
-
-        if (!p && !z_not_found_printed && !z_detected) {
-            // Z가 없고, 아직 "Z 없음"을 출력한 적 없다면 한 번만 출력
-            fprintf(stderr, "[interpose] read(fd=%d, count=%zu) → %zd bytes: Z 없음\n", fd, count, n);
-            z_not_found_printed = 1;
-        }
+    // 읽은 데이터가 있을 경우 검사 (이전 read 의 끝과 이어서)
+    if (n > 0 && g_ready && fd >= 0 && fd < MAX_FD) {
+        fd_scan_t* f = &S[fd];
+        f->fd = fd;
+        pscan_feed(&g_ps, &f->st, buf, (size_t)n, on_match, f);
     }
 
     return n;
 }
+
+/* close wrapper: FD가 재사용되기 전에 요약을 내고 스트림 위치를 0으로 */
+int close(int fd)
+{
+    if (!closep) closep = dlsym(RTLD_NEXT, "close");
+    if (g_ready && fd >= 0 && fd < MAX_FD) finish_fd(fd);
+    return closep(fd);
+}
 #endif
@@ -1,43 +1,94 @@
+// build:  make libnetprof.so
+// run  :  LD_PRELOAD=./libnetprof.so ./server
+// env  :  NETPROF_INTERVAL_MS=250   // 보고 주기(ms)
+//         NETPROF_PREFIX="[np] "    // 로그 접두사
+//         NETPROF_QUIET=1           // stderr 보고 끄기 (netprof_top 으로만 볼 때, 보고 스레드는 그대로 돌며 TCP_INFO 를 올림)
+//         NETPROF_SHM=/이름         // 공유 메모리 이름 (기본 /netprof.<pid>)
+//         NETPROF_TCPINFO=0         // TCP_INFO 표본 끄기 (기본 켬)
+// 보기 :  ./netprof_top <pid>
+//
+// 모든 소켓 FD의 송수신 바이트/호출 수를 공유 메모리의 FD별 슬롯에 원자적으로 누적한다
+// (배치는 netprof_shm.h). 후킹 함수는 카운터 덧셈만 하고, 주기 보고는 별도 보고 스레드가 한다.
+// 후킹: read/write, send/recv, readv/writev, sendmsg/recvmsg, sendmmsg/recvmmsg (바이트는 메시지 합),
+// sendfile, splice (소켓 쪽만), accept/accept4, close, dup/dup2/dup3.
+// close 하면 그 FD의 누적값을 "닫힌 연결" 합계로 옮기고 슬롯을 비운다 (FD 재사용 대비).
+// accept 로 받은 FD 와 dup2/dup3 로 덮인 FD 도 같은 방식으로 비운다 (놓친 close 가 있어도 새 연결로 시작).
+// dup 한 FD 는 같은 연결이라 닫힐 때 바이트만 옮기고 연결 수에는 세지 않는다.
+// 닫힌 연결 합계는 스레드마다 다른 샤드에 더해 여러 스레드가 동시에 close 해도 경합이 없다.
+// 보고 스레드는 주기마다 TCP 소켓의 getsockopt(TCP_INFO) 를 떠서 (RTT, cwnd, 재전송, 전달 속도,
+// rcv_space, busy/rwnd/sndbuf 제한 시간) 처리량 옆에 적고 공유 메모리에도 올린다.
+// 처리량이 떨어질 때 네트워크(cwnd/RTT/재전송)인지, 상대 수신 윈도인지, 앱인지를 같은 줄에서 본다.
 #ifdef RUNTIME
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
-#include <unistd.h>      // read, write
+#include <unistd.h>      // read, write, close
 #include <string.h>
+#include <stdarg.h>
 #include <errno.h>
 #include <dlfcn.h>       // dlsym, RTLD_NEXT
 #include <sys/types.h>
-#include <sys/socket.h>  // getsockopt, SOL_SOCKET, SO_TYPE
+#include <sys/socket.h>  // getsockopt, SOL_SOCKET, SO_TYPE, sendmsg, recvmsg
+#include <sys/uio.h>     // readv, writev
+#include <sys/sendfile.h>
+#include <sys/syscall.h> // SYS_gettid
+#include <stddef.h>      // offsetof
+#include <netinet/in.h>
+#include <linux/tcp.h>   // struct tcp_info (glibc 판에는 delivery_rate 등 새 필드가 없음)
+#include <arpa/inet.h>   // inet_ntop
 #include <time.h>        // clock_gettime
+#include <fcntl.h>       // O_* (shm_open)
+#include <pthread.h>     // 보고 스레드
+#include <sys/mman.h>    // shm_open, mmap
+
+#include "netprof_shm.h"
 
 // ===== 설정 =====
 static int  g_interval_ms = 250;     // 로그 주기(ms)
 static char g_prefix[64]  = "";      // 로그 접두사
+static int  g_quiet       = 0;       // stderr 보고 끄기
+static char g_shm_name[64];          // 만든 공유 메모리 이름 (종료 시 삭제)
+static int  g_tcpinfo      = 1;       // 주기마다 TCP_INFO 표본
 
 // ===== 원함수 포인터 =====
-static ssize_t (*real_read)(int, void*, size_t)         = NULL;
-static ssize_t (*real_write)(int, const void*, size_t)  = NULL;
+static ssize_t (*real_read)(int, void*, size_t)                 = NULL;
+static ssize_t (*real_write)(int, const void*, size_t)          = NULL;
+static ssize_t (*real_send)(int, const void*, size_t, int)      = NULL;
+static ssize_t (*real_recv)(int, void*, size_t, int)            = NULL;
+static ssize_t (*real_sendmsg)(int, const struct msghdr*, int)  = NULL;
+static ssize_t (*real_recvmsg)(int, struct msghdr*, int)        = NULL;
+static ssize_t (*real_readv)(int, const struct iovec*, int)     = NULL;
+static ssize_t (*real_writev)(int, const struct iovec*, int)    = NULL;
+static int     (*real_close)(int)                               = NULL;
+static int     (*real_recvmmsg)(int, struct mmsghdr*, unsigned int, int, struct timespec*) = NULL;
+static int     (*real_sendmmsg)(int, struct mmsghdr*, unsigned int, int)                   = NULL;
+static ssize_t (*real_sendfile)(int, int, off_t*, size_t)                                  = NULL;
+static ssize_t (*real_sendfile64)(int, int, off64_t*, size_t)                              = NULL;
+static ssize_t (*real_splice)(int, loff_t*, int, loff_t*, size_t, unsigned int)            = NULL;
+static int     (*real_accept)(int, struct sockaddr*, socklen_t*)                           = NULL;
+static int     (*real_accept4)(int, struct sockaddr*, socklen_t*, int)                     = NULL;
+static int     (*real_dup)(int)                                                            = NULL;
+static int     (*real_dup2)(int, int)                                                      = NULL;
+static int     (*real_dup3)(int, int, int)                                                 = NULL;
 
-// ===== 추적 대상: 단 하나의 소켓 FD =====
-typedef struct {
-  int          tracked_fd;     // 추적 중인 소켓 FD (-1이면 미설정)
-  uint64_t     in_bytes;       // 누적 수신
-  uint64_t     out_bytes;      // 누적 송신
-  struct timespec t0;          // 시작 시각
-  struct timespec last_report; // 마지막 보고 시각
-  int          active;         // t0 설정 여부
-} one_stat_t;
+// ===== FD별 슬롯 (공유 메모리) =====
+static np_shm_t*   g_shm;            // 공유 메모리 (실패하면 익명 매핑)
+static np_slot_t*  F;                // = g_shm->slot
+static np_shard_t* CLOSED;           // = g_shm->closed
+static uint64_t    g_t0_ns;
+static int         g_reporter_on;    // 보고 스레드 실행 여부 (fork 후 자식에서 0)
 
-static one_stat_t S = { .tracked_fd = -1, .active = 0 };
+// 보고 스레드만 쓰는 직전 주기 스냅샷
+static uint32_t  P_seq[NP_MAX_FD];
+static uint64_t  P_in[NP_MAX_FD], P_out[NP_MAX_FD];
+static uint64_t  P_total_in, P_total_out;
+static uint64_t  P_busy[NP_MAX_FD], P_rwnd[NP_MAX_FD], P_sndbuf[NP_MAX_FD];   // TCP 제한 시간 (us)
 
 // ===== 유틸 =====
-static inline void now(struct timespec* ts){ clock_gettime(CLOCK_MONOTONIC, ts); }
-static inline double secdiff(const struct timespec* a, const struct timespec* b){
-  return (a->tv_sec - b->tv_sec) + (a->tv_nsec - b->tv_nsec)/1e9;
-}
-static inline long ms_since(const struct timespec* a, const struct timespec* b){
-  return (long)(secdiff(a,b) * 1000.0);
+static inline uint64_t now_ns(void){
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 static int is_socket_fd(int fd){
   int type; socklen_t len = sizeof(type);
@@ -47,33 +98,321 @@ static void safe_log(const char* s, size_t n){
   if (!real_write) return;
   (void)real_write(STDERR_FILENO, s, n); // 재귀 방지: 원 write로 직접 출력
 }
-static void maybe_pick_fd_and_start(int fd){
-  if (S.tracked_fd != -1) return;            // 이미 선택됨
-  if (!is_socket_fd(fd))   return;            // 소켓이 아니면 무시
-  S.tracked_fd = fd;                          // 이 소켓을 추적
-  S.in_bytes = S.out_bytes = 0;
-  memset(&S.last_report, 0, sizeof(S.last_report));
-  now(&S.t0);
-  S.active = 1;
-}
-static void maybe_report(void){
-  if (!S.active || S.tracked_fd == -1) return;
-  struct timespec t; now(&t);
-  if ((S.last_report.tv_sec || S.last_report.tv_nsec) &&
-      ms_since(&t, &S.last_report) < g_interval_ms) return;
-  S.last_report = t;
-
-  double el = secdiff(&t, &S.t0); if (el <= 0) el = 1e-9;
-  double inMB  = S.in_bytes  / (1024.0*1024.0);
-  double outMB = S.out_bytes / (1024.0*1024.0);
-
-  char line[256];
-  int n = snprintf(line, sizeof(line),
-      "%s[fd=%d] %.2fs  IN: %.2f MB (%.2f MB/s)  OUT: %.2f MB (%.2f MB/s)\n",
-      g_prefix, S.tracked_fd, el,
-      inMB,  inMB/el,
-      outMB, outMB/el);
-  if (n > 0) safe_log(line, (size_t)n);
+static void* resolve(const char* name){
+  void* p = dlsym(RTLD_NEXT, name);
+  if (!p) { const char* err = dlerror(); if (err) fputs(err, stderr); }
+  return p;
+}
+static void fmt_peer(int fd, char* out, size_t cap){
+  struct sockaddr_storage ss; socklen_t len = sizeof(ss);
+  char ip[INET6_ADDRSTRLEN];
+  if (getpeername(fd, (struct sockaddr*)&ss, &len) < 0) { snprintf(out, cap, "-"); return; }
+  if (ss.ss_family == AF_INET) {
+    const struct sockaddr_in* a = (const struct sockaddr_in*)&ss;
+    inet_ntop(AF_INET, &a->sin_addr, ip, sizeof(ip));
+    snprintf(out, cap, "%s:%u", ip, (unsigned)ntohs(a->sin_port));
+  } else if (ss.ss_family == AF_INET6) {
+    const struct sockaddr_in6* a = (const struct sockaddr_in6*)&ss;
+    inet_ntop(AF_INET6, &a->sin6_addr, ip, sizeof(ip));
+    snprintf(out, cap, "[%s]:%u", ip, (unsigned)ntohs(a->sin6_port));
+  } else {
+    snprintf(out, cap, "fam=%d", ss.ss_family);
+  }
+}
+
+// seqlock 쓰기 구간 (슬롯의 정체가 바뀌는 동안 seq 홀수)
+static inline void slot_begin(np_slot_t* s){
+  __atomic_fetch_add(&s->seq, 1, __ATOMIC_ACQ_REL);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+static inline void slot_end(np_slot_t* s){
+  __atomic_fetch_add(&s->seq, 1, __ATOMIC_RELEASE);
+}
+
+// 소켓 FD면 슬롯 반환 (판별과 주소 조회는 FD마다 처음 한 번만)
+static inline np_slot_t* fd_stat(int fd){
+  if (fd < 0 || fd >= NP_MAX_FD || !F) return NULL;
+  np_slot_t* s = &F[fd];
+  uint32_t st = __atomic_load_n(&s->state, __ATOMIC_ACQUIRE);
+  if (st == NP_FD_UNKNOWN) {
+    // 처음 보는 FD: 한 스레드만 판별하고 나머지는 끝날 때까지 기다린다
+    if (!__atomic_compare_exchange_n(&s->state, &st, NP_FD_PENDING, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      while ((st = __atomic_load_n(&s->state, __ATOMIC_ACQUIRE)) == NP_FD_PENDING) ;
+      return st == NP_FD_SOCKET ? s : NULL;
+    }
+    if (is_socket_fd(fd)) {
+      slot_begin(s);
+      s->t0_ns = now_ns();
+      s->tcp_ok = 0;   // 이전 연결의 표본이 남지 않도록
+      fmt_peer(fd, s->peer, sizeof(s->peer));
+      slot_end(s);
+      int m = __atomic_load_n(&g_shm->max_fd, __ATOMIC_RELAXED);
+      while (fd > m && !__atomic_compare_exchange_n(&g_shm->max_fd, &m, fd, 1,
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+      st = NP_FD_SOCKET;
+    } else {
+      st = NP_FD_NOT_SOCKET;
+    }
+    __atomic_store_n(&s->state, st, __ATOMIC_RELEASE);
+  }
+  return st == NP_FD_SOCKET ? s : NULL;
+}
+
+// ===== TCP_INFO 표본 (보고 스레드만) =====
+// seq: 표본을 뜨기 전에 읽은 슬롯 seq. 그 사이 close/재사용됐으면 버린다
+static void sample_tcp(int fd, np_slot_t* s, uint32_t seq, uint64_t t){
+  struct tcp_info ti;
+  socklen_t len = sizeof(ti);
+  memset(&ti, 0, sizeof(ti));
+  if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) < 0 ||
+      __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != seq) return;   // TCP 가 아니거나 그 사이 바뀜
+  // 오래된 커널은 구조체 앞부분만 채운다: 없는 필드는 0 으로 둔다
+  int has_rate = len >= offsetof(struct tcp_info, tcpi_delivery_rate) + sizeof(ti.tcpi_delivery_rate);
+  int has_lim  = len >= offsetof(struct tcp_info, tcpi_sndbuf_limited) + sizeof(ti.tcpi_sndbuf_limited);
+  np_tcp_t* x = &s->tcp;
+  __atomic_fetch_add(&s->tcp_seq, 1, __ATOMIC_ACQ_REL);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  x->sample_ns         = t;
+  x->rtt_us            = ti.tcpi_rtt;
+  x->rttvar_us         = ti.tcpi_rttvar;
+  x->snd_cwnd          = ti.tcpi_snd_cwnd;
+  x->snd_mss           = ti.tcpi_snd_mss;
+  x->total_retrans     = ti.tcpi_total_retrans;
+  x->rcv_space         = ti.tcpi_rcv_space;
+  x->delivery_rate     = has_rate ? ti.tcpi_delivery_rate : 0;
+  x->app_limited       = has_rate ? ti.tcpi_delivery_rate_app_limited : 0;
+  x->busy_us           = has_lim ? ti.tcpi_busy_time : 0;
+  x->rwnd_limited_us   = has_lim ? ti.tcpi_rwnd_limited : 0;
+  x->sndbuf_limited_us = has_lim ? ti.tcpi_sndbuf_limited : 0;
+  s->tcp_ok = 1;
+  __atomic_fetch_add(&s->tcp_seq, 1, __ATOMIC_RELEASE);
+  // 쓰는 사이에 닫히고 재사용됐으면 새 연결에 남기지 않는다
+  if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != seq) s->tcp_ok = 0;
+}
+
+// ===== 보고 =====
+typedef struct { char buf[16384]; size_t len; } out_t;
+
+static void out_line(out_t* o, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void out_line(out_t* o, const char* fmt, ...){
+  if (g_quiet) return;   // 조용한 모드: 표본/공유 메모리 갱신만 하고 글은 만들지 않는다
+  if (o->len > sizeof(o->buf) - 256) { safe_log(o->buf, o->len); o->len = 0; }
+  va_list ap; va_start(ap, fmt);
+  int n = vsnprintf(o->buf + o->len, sizeof(o->buf) - o->len, fmt, ap);
+  va_end(ap);
+  if (n > 0) o->len += (size_t)n < sizeof(o->buf) - o->len ? (size_t)n : sizeof(o->buf) - o->len - 1;
+}
+
+// 연결별(이번 주기에 주고받은 게 있는 것만) + 전체 처리량. final 이면 열린 연결 전부와 누적 합계
+static void report(uint64_t t, double dt, int final){
+  static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;   // 보고 스레드와 소멸자 사이 (I/O 경로 아님)
+  static out_t o;
+  pthread_mutex_lock(&lock);
+  double el = (t - g_t0_ns) / 1e9; if (el <= 0) el = 1e-9;
+  if (dt <= 0) dt = 1e-9;
+  uint64_t tin = 0, tout = 0, live = 0;
+  int maxfd = __atomic_load_n(&g_shm->max_fd, __ATOMIC_RELAXED);
+
+  o.len = 0;
+  for (int fd = 0; fd <= maxfd; fd++) {
+    np_slot_t* s = &F[fd];
+    if (__atomic_load_n(&s->state, __ATOMIC_ACQUIRE) != NP_FD_SOCKET) continue;
+    uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    uint64_t in  = __atomic_load_n(&s->in_bytes,  __ATOMIC_RELAXED);
+    uint64_t out = __atomic_load_n(&s->out_bytes, __ATOMIC_RELAXED);
+    if (seq & 1) continue;                                                  // 열리거나 닫히는 중
+    if (P_seq[fd] != seq) {                                                // 그 사이 닫히고 재사용됨
+      P_seq[fd] = seq; P_in[fd] = P_out[fd] = 0;
+      P_busy[fd] = P_rwnd[fd] = P_sndbuf[fd] = 0;
+    }
+    uint64_t din = in - P_in[fd], dout = out - P_out[fd];
+    P_in[fd] = in; P_out[fd] = out;
+    tin += in; tout += out; live++;
+    if (g_tcpinfo) sample_tcp(fd, s, seq, t);
+    if (!final && din == 0 && dout == 0) continue;
+
+    // TCP 표본: busy/rwnd/sndbuf 제한은 이번 주기(final 이면 연결 전체) 시간 중 비율
+    char tcp[256] = "";
+    if (g_tcpinfo && s->tcp_ok) {
+      const np_tcp_t* x = &s->tcp;
+      double span = final ? (t - s->t0_ns) / 1e3 : dt * 1e6;   // us
+      if (span <= 0) span = 1;
+      uint64_t db = x->busy_us - P_busy[fd], dr = x->rwnd_limited_us - P_rwnd[fd];
+      uint64_t dsb = x->sndbuf_limited_us - P_sndbuf[fd];
+      if (final) { db = x->busy_us; dr = x->rwnd_limited_us; dsb = x->sndbuf_limited_us; }
+      P_busy[fd] = x->busy_us; P_rwnd[fd] = x->rwnd_limited_us; P_sndbuf[fd] = x->sndbuf_limited_us;
+      double pb = db * 100.0 / span, pr = dr * 100.0 / span, ps = dsb * 100.0 / span;
+      if (pb > 100) pb = 100;   // 표본 시각과 주기가 조금 어긋나 100% 를 살짝 넘는 경우
+      if (pr > 100) pr = 100;
+      if (ps > 100) ps = 100;
+      snprintf(tcp, sizeof(tcp),
+               "  | rtt %.2f/%.2fms cwnd %u mss %u retr %u dlv %.2f MB/s%s rcv_space %uKB"
+               " busy %.0f%% rwnd_lim %.0f%% sndbuf_lim %.0f%%",
+               x->rtt_us / 1e3, x->rttvar_us / 1e3, x->snd_cwnd, x->snd_mss, x->total_retrans,
+               x->delivery_rate / (1024.0*1024.0), x->app_limited ? " (app-limited)" : "",
+               x->rcv_space / 1024, pb, pr, ps);
+    }
+
+    const char* peer = s->peer;
+    if (final) {
+      double cel = (t - s->t0_ns) / 1e9; if (cel <= 0) cel = 1e-9;
+      out_line(&o, "%s[fd=%d %s] FINAL  T=%.2fs  IN: %.2f MB (%.2f MB/s)  OUT: %.2f MB (%.2f MB/s)%s\n",
+               g_prefix, fd, peer, cel,
+               in / (1024.0*1024.0), in / (1024.0*1024.0) / cel,
+               out / (1024.0*1024.0), out / (1024.0*1024.0) / cel, tcp);
+    } else {
+      out_line(&o, "%s[fd=%d %s] %.2fs  IN: %.2f MB (%.2f MB/s)  OUT: %.2f MB (%.2f MB/s)%s\n",
+               g_prefix, fd, peer, el,
+               in / (1024.0*1024.0), din / (1024.0*1024.0) / dt,
+               out / (1024.0*1024.0), dout / (1024.0*1024.0) / dt, tcp);
+    }
+  }
+
+  uint64_t closed = 0;
+  for (int i = 0; i < NP_SHARDS; i++) {
+    tin    += __atomic_load_n(&CLOSED[i].in_bytes,  __ATOMIC_RELAXED);
+    tout   += __atomic_load_n(&CLOSED[i].out_bytes, __ATOMIC_RELAXED);
+    closed += __atomic_load_n(&CLOSED[i].conns,     __ATOMIC_RELAXED);
+  }
+  // close 가 FD 항목에서 샤드로 옮기는 도중이면 합계가 잠깐 줄어 보일 수 있다 → 0 으로
+  uint64_t din  = tin  > P_total_in  ? tin  - P_total_in  : 0;
+  uint64_t dout = tout > P_total_out ? tout - P_total_out : 0;
+  double ri = final ? tin  / (1024.0*1024.0) / el : din  / (1024.0*1024.0) / dt;
+  double ro = final ? tout / (1024.0*1024.0) / el : dout / (1024.0*1024.0) / dt;
+  P_total_in = tin; P_total_out = tout;
+  out_line(&o, "%s[all open=%llu closed=%llu] %s%.2fs  IN: %.2f MB (%.2f MB/s)  OUT: %.2f MB (%.2f MB/s)\n",
+           g_prefix, (unsigned long long)live, (unsigned long long)closed, final ? "FINAL  T=" : "", el,
+           tin / (1024.0*1024.0), ri, tout / (1024.0*1024.0), ro);
+  if (!g_quiet) safe_log(o.buf, o.len);
+  pthread_mutex_unlock(&lock);
+}
+
+// 보고 스레드: 주기마다 깨어나 보고한다 (후킹 함수는 보고에 관여하지 않음)
+static void* reporter_main(void* arg){
+  (void)arg;
+  uint64_t last = now_ns();
+  while (1) {
+    struct timespec ts = { g_interval_ms / 1000, (g_interval_ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    uint64_t t = now_ns();
+    report(t, (t - last) / 1e9, 0);
+    last = t;
+  }
+  return NULL;
+}
+
+// 첫 소켓 활동 때(또는 fork 후 자식에서 첫 활동 때) 보고 스레드를 띄운다
+// (NETPROF_QUIET 이어도 띄운다: netprof_top 이 보는 TCP_INFO 표본은 이 스레드가 뜬다)
+static void start_reporter(void){
+  int expect = 0;
+  if (!__atomic_compare_exchange_n(&g_reporter_on, &expect, 1, 0,
+                                              __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) return;
+  pthread_t tid;
+  pthread_attr_t at;
+  pthread_attr_init(&at);
+  pthread_attr_setdetachstate(&at, PTHREAD_CREATE_DETACHED);
+  if (pthread_create(&tid, &at, reporter_main, NULL) != 0)
+    __atomic_store_n(&g_reporter_on, 0, __ATOMIC_RELEASE);
+  pthread_attr_destroy(&at);
+}
+
+static inline void account_in(int fd, ssize_t n){
+  if (n <= 0) return;
+  np_slot_t* s = fd_stat(fd);
+  if (!s) return;
+  __atomic_fetch_add(&s->in_bytes, (uint64_t)n, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&s->in_calls, 1, __ATOMIC_RELAXED);
+  if (!__atomic_load_n(&g_reporter_on, __ATOMIC_RELAXED)) start_reporter();
+}
+static inline void account_out(int fd, ssize_t n){
+  if (n <= 0) return;
+  np_slot_t* s = fd_stat(fd);
+  if (!s) return;
+  __atomic_fetch_add(&s->out_bytes, (uint64_t)n, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&s->out_calls, 1, __ATOMIC_RELAXED);
+  if (!__atomic_load_n(&g_reporter_on, __ATOMIC_RELAXED)) start_reporter();
+}
+
+// dup 로 생긴 FD (닫혀도 연결은 원래 FD 쪽에 남아 있음). 공유 메모리에는 없는 내부 표시
+static uint8_t D_dup[NP_MAX_FD];
+
+// close: 누적값을 닫힌 연결 샤드로 옮기고 슬롯을 비운다
+static void retire_fd(int fd){
+  if (fd < 0 || fd >= NP_MAX_FD || !F) return;
+  np_slot_t* s = &F[fd];
+  int was_dup = __atomic_exchange_n(&D_dup[fd], 0, __ATOMIC_RELAXED);
+  uint32_t st = __atomic_load_n(&s->state, __ATOMIC_ACQUIRE);
+  if (st == NP_FD_NOT_SOCKET) { __atomic_store_n(&s->state, NP_FD_UNKNOWN, __ATOMIC_RELEASE); return; }
+  if (st != NP_FD_SOCKET) return;
+  static __thread int shard = -1;
+  if (shard < 0) shard = (int)(syscall(SYS_gettid) & (NP_SHARDS - 1));
+  np_shard_t* c = &CLOSED[shard];
+  slot_begin(s);
+  __atomic_fetch_add(&c->in_bytes,  __atomic_exchange_n(&s->in_bytes,  0, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+  __atomic_fetch_add(&c->out_bytes, __atomic_exchange_n(&s->out_bytes, 0, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+  if (!was_dup) __atomic_fetch_add(&c->conns, 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&s->in_calls,  0, __ATOMIC_RELAXED);
+  __atomic_store_n(&s->out_calls, 0, __ATOMIC_RELAXED);
+  s->peer[0] = '\0';
+  __atomic_store_n(&s->state, NP_FD_UNKNOWN, __ATOMIC_RELEASE);
+  slot_end(s);
+}
+
+// 공유 메모리 세그먼트를 만들고 헤더를 채운다. 실패하면 익명 매핑 (stderr 보고만)
+static np_shm_t* shm_create(void){
+  np_shm_t* m = MAP_FAILED;
+  int fd = shm_open(g_shm_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0 && ftruncate(fd, sizeof(np_shm_t)) == 0)
+    m = mmap(NULL, sizeof(np_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (fd >= 0) real_close(fd);
+  if (m == MAP_FAILED) {
+    char line[192];
+    int n = snprintf(line, sizeof(line), "%snetprof: 공유 메모리 %s 생성 실패 (errno=%d), netprof_top 사용 불가\n",
+                     g_prefix, g_shm_name, errno);
+    if (n > 0) safe_log(line, (size_t)n);
+    shm_unlink(g_shm_name);
+    g_shm_name[0] = '\0';
+    m = mmap(NULL, sizeof(np_shm_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) return NULL;
+  }
+  m->pid       = (uint32_t)getpid();
+  m->nslots    = NP_MAX_FD;
+  m->slot_size = sizeof(np_slot_t);
+  m->max_fd    = -1;
+  m->t0_ns     = g_t0_ns;
+  m->version   = NP_VERSION;
+  __atomic_store_n(&m->magic, NP_MAGIC, __ATOMIC_RELEASE);   // 마지막에 써서 다 채워졌음을 알림
+  return m;
+}
+
+// fork 후 자식: 부모의 세그먼트를 그대로 쓰면 카운터가 섞이므로, 자기 pid 이름으로 새로 만들어
+// 지금 내용을 복사한 뒤 같은 주소에 덮어 매핑한다 (F/CLOSED 포인터는 그대로 유효).
+// NETPROF_SHM 으로 이름을 정했으면 부모 것을 덮어쓰지 않도록 자식은 내보내지 않고 개인 사본만 쓴다.
+// 보고 스레드는 복제되지 않으므로 다음 활동 때 새로 띄운다
+static void atfork_child(void){
+  g_reporter_on = 0;
+  if (!g_shm || !g_shm_name[0]) return;
+  int fd = -1;
+  if (!getenv("NETPROF_SHM")) {
+    snprintf(g_shm_name, sizeof(g_shm_name), "/netprof.%d", (int)getpid());
+    fd = shm_open(g_shm_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  }
+  if (fd >= 0 && ftruncate(fd, sizeof(np_shm_t)) == 0 &&
+      real_write(fd, g_shm, sizeof(np_shm_t)) == (ssize_t)sizeof(np_shm_t) &&
+      mmap(g_shm, sizeof(np_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED) {
+    g_shm->pid = (uint32_t)getpid();
+  } else {
+    void* tmp = mmap(NULL, sizeof(np_shm_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (tmp != MAP_FAILED) {
+      memcpy(tmp, g_shm, sizeof(np_shm_t));
+      mremap(tmp, sizeof(np_shm_t), sizeof(np_shm_t), MREMAP_MAYMOVE | MREMAP_FIXED, g_shm);
+    }
+    if (fd >= 0) shm_unlink(g_shm_name);
+    g_shm_name[0] = '\0';
+  }
+  if (fd >= 0) real_close(fd);
 }
 
 // ===== 초기화/해제 =====
@@ -82,82 +421,212 @@ static void init_once(void){
   if (p && *p) { int v = atoi(p); if (v > 0) g_interval_ms = v; }
   const char* pref = getenv("NETPROF_PREFIX");
   if (pref && *pref) snprintf(g_prefix, sizeof(g_prefix), "%s", pref);
+  const char* q = getenv("NETPROF_QUIET");
+  g_quiet = q && *q && *q != '0';
+  const char* ti = getenv("NETPROF_TCPINFO");
+  if (ti && *ti == '0') g_tcpinfo = 0;
+  const char* name = getenv("NETPROF_SHM");
+  if (name && *name) snprintf(g_shm_name, sizeof(g_shm_name), "%s", name);
+  else               snprintf(g_shm_name, sizeof(g_shm_name), "/netprof.%d", (int)getpid());
+  g_t0_ns = now_ns();
 
-  char line[128];
+  g_shm = shm_create();
+  if (g_shm) { F = g_shm->slot; CLOSED = g_shm->closed; }
+  pthread_atfork(NULL, NULL, atfork_child);
+
+  char line[192];
   int n = snprintf(line, sizeof(line),
-      "%snetprof(min): interval=%dms active\n", g_prefix, g_interval_ms);
+      "%snetprof: interval=%dms%s active (all sockets), tcp_info=%s, shm=%s\n", g_prefix, g_interval_ms,
+      g_quiet ? " (quiet)" : "", g_tcpinfo ? "on" : "off", g_shm_name[0] ? g_shm_name : "<none>");
   if (n > 0) safe_log(line, (size_t)n);
 }
 
 __attribute__((constructor))
 static void ctor(void){
-  char *err;
-  real_read  = dlsym(RTLD_NEXT, "read");  
-  if ((err = dlerror()) != NULL)
-  { 
-    fputs(err, stderr); exit(1); 
-  }
-  real_write = dlsym(RTLD_NEXT, "write"); 
-  
-  if ((err = dlerror()) != NULL)
-  { 
-    fputs(err, stderr); exit(1); 
-  }
+  real_read    = resolve("read");
+  real_write   = resolve("write");
+  if (!real_read || !real_write) exit(1);
+  real_send    = resolve("send");
+  real_recv    = resolve("recv");
+  real_sendmsg = resolve("sendmsg");
+  real_recvmsg = resolve("recvmsg");
+  real_readv   = resolve("readv");
+  real_writev  = resolve("writev");
+  real_close   = resolve("close");
+  real_recvmmsg   = resolve("recvmmsg");
+  real_sendmmsg   = resolve("sendmmsg");
+  real_sendfile   = resolve("sendfile");
+  real_sendfile64 = resolve("sendfile64");
+  real_splice     = resolve("splice");
+  real_accept     = resolve("accept");
+  real_accept4    = resolve("accept4");
+  real_dup        = resolve("dup");
+  real_dup2       = resolve("dup2");
+  real_dup3       = resolve("dup3");
   init_once();
 }
 
 __attribute__((destructor))
 static void dtor(void){
-  if (!S.active || S.tracked_fd == -1) return;
-  struct timespec t; now(&t);
-  double el = secdiff(&t, &S.t0); if (el <= 0) el = 1e-9;
-  double inMB  = S.in_bytes  / (1024.0*1024.0);
-  double outMB = S.out_bytes / (1024.0*1024.0);
-  char line[256];
-  int n = snprintf(line, sizeof(line),
-      "%s[fd=%d] FINAL  T=%.2fs  IN: %.2f MB (%.2f MB/s)  OUT: %.2f MB (%.2f MB/s)\n",
-      g_prefix, S.tracked_fd, el,
-      inMB,  inMB/el,
-      outMB, outMB/el);
-  if (n > 0) safe_log(line, (size_t)n);
+  if (!g_shm) return;
+  if (!g_quiet) report(now_ns(), 0, 1);
+  if (g_shm_name[0]) shm_unlink(g_shm_name);   // 뷰어가 붙어 있으면 매핑은 그쪽에서 계속 보임
 }
 
-// ===== 후킹 함수 =====  
+// ===== 후킹 함수 =====
+// 원함수를 아직 못 찾았으면(생성자 전 호출) 여기서 찾는다
+#define ENSURE(fn, name) \
+  if (!fn && !(fn = resolve(name))) { errno = EIO; return -1; }
+
 ssize_t read(int fd, void* buf, size_t count){
-  if (!real_read){ 
-    char *err; 
-    real_read = dlsym(RTLD_NEXT, "read"); 
-    if ((err = dlerror()) != NULL)
-    { 
-      fputs(err, stderr); errno = EIO; return -1; 
-    } 
-  }
+  ENSURE(real_read, "read");
   ssize_t n = real_read(fd, buf, count);
-  if (n > 0){
-    if (S.tracked_fd == -1) maybe_pick_fd_and_start(fd);
-    if (fd == S.tracked_fd){
-      S.in_bytes += (uint64_t)n;
-      maybe_report();
-    }
-  }
+  account_in(fd, n);
   return n;
 }
 
 ssize_t write(int fd, const void* buf, size_t count){
-  if (!real_write){ char *err; real_write = dlsym(RTLD_NEXT, "write"); 
-    if ((err = dlerror()) != NULL)
-    { 
-      fputs(err, stderr); errno = EIO; return -1;
-    } 
-  }
+  ENSURE(real_write, "write");
   ssize_t n = real_write(fd, buf, count);
-  if (n > 0){
-    if (S.tracked_fd == -1) maybe_pick_fd_and_start(fd);
-    if (fd == S.tracked_fd){
-      S.out_bytes += (uint64_t)n;
-      maybe_report();
-    }
-  }
+  account_out(fd, n);
+  return n;
+}
+
+ssize_t recv(int fd, void* buf, size_t count, int flags){
+  ENSURE(real_recv, "recv");
+  ssize_t n = real_recv(fd, buf, count, flags);
+  if (!(flags & MSG_PEEK)) account_in(fd, n);   // PEEK 는 소비하지 않으므로 제외
+  return n;
+}
+
+ssize_t send(int fd, const void* buf, size_t count, int flags){
+  ENSURE(real_send, "send");
+  ssize_t n = real_send(fd, buf, count, flags);
+  account_out(fd, n);
+  return n;
+}
+
+ssize_t recvmsg(int fd, struct msghdr* msg, int flags){
+  ENSURE(real_recvmsg, "recvmsg");
+  ssize_t n = real_recvmsg(fd, msg, flags);
+  if (!(flags & MSG_PEEK)) account_in(fd, n);
+  return n;
+}
+
+ssize_t sendmsg(int fd, const struct msghdr* msg, int flags){
+  ENSURE(real_sendmsg, "sendmsg");
+  ssize_t n = real_sendmsg(fd, msg, flags);
+  account_out(fd, n);
+  return n;
+}
+
+ssize_t readv(int fd, const struct iovec* iov, int iovcnt){
+  ENSURE(real_readv, "readv");
+  ssize_t n = real_readv(fd, iov, iovcnt);
+  account_in(fd, n);
   return n;
 }
+
+ssize_t writev(int fd, const struct iovec* iov, int iovcnt){
+  ENSURE(real_writev, "writev");
+  ssize_t n = real_writev(fd, iov, iovcnt);
+  account_out(fd, n);
+  return n;
+}
+
+// recvmmsg/sendmmsg 는 메시지 수를 돌려준다. 바이트는 처리된 메시지들의 msg_len 합
+static ssize_t mmsg_bytes(const struct mmsghdr* v, int n){
+  ssize_t sum = 0;
+  for (int i = 0; i < n; i++) sum += v[i].msg_len;
+  return sum;
+}
+
+int recvmmsg(int fd, struct mmsghdr* vec, unsigned int vlen, int flags, struct timespec* timeout){
+  ENSURE(real_recvmmsg, "recvmmsg");
+  int n = real_recvmmsg(fd, vec, vlen, flags, timeout);
+  if (n > 0 && !(flags & MSG_PEEK)) account_in(fd, mmsg_bytes(vec, n));
+  return n;
+}
+
+int sendmmsg(int fd, struct mmsghdr* vec, unsigned int vlen, int flags){
+  ENSURE(real_sendmmsg, "sendmmsg");
+  int n = real_sendmmsg(fd, vec, vlen, flags);
+  if (n > 0) account_out(fd, mmsg_bytes(vec, n));
+  return n;
+}
+
+// sendfile/splice: 데이터가 사용자 공간을 거치지 않는 경로. 소켓인 쪽에만 센다
+ssize_t sendfile(int out_fd, int in_fd, off_t* off, size_t count){
+  ENSURE(real_sendfile, "sendfile");
+  ssize_t n = real_sendfile(out_fd, in_fd, off, count);
+  account_out(out_fd, n);
+  return n;
+}
+
+ssize_t sendfile64(int out_fd, int in_fd, off64_t* off, size_t count){
+  ENSURE(real_sendfile64, "sendfile64");
+  ssize_t n = real_sendfile64(out_fd, in_fd, off, count);
+  account_out(out_fd, n);
+  return n;
+}
+
+ssize_t splice(int fd_in, loff_t* off_in, int fd_out, loff_t* off_out, size_t len, unsigned int flags){
+  ENSURE(real_splice, "splice");
+  ssize_t n = real_splice(fd_in, off_in, fd_out, off_out, len, flags);
+  account_in(fd_in, n);     // 소켓 → 파이프
+  account_out(fd_out, n);   // 파이프 → 소켓
+  return n;
+}
+
+// 새 연결: 그 번호의 슬롯에 놓친 close 의 흔적이 있으면 닫힌 연결로 넘기고 새로 시작
+int accept(int fd, struct sockaddr* addr, socklen_t* len){
+  ENSURE(real_accept, "accept");
+  int cfd = real_accept(fd, addr, len);
+  if (cfd >= 0) { int e = errno; retire_fd(cfd); fd_stat(cfd); errno = e; }
+  return cfd;
+}
+
+int accept4(int fd, struct sockaddr* addr, socklen_t* len, int flags){
+  ENSURE(real_accept4, "accept4");
+  int cfd = real_accept4(fd, addr, len, flags);
+  if (cfd >= 0) { int e = errno; retire_fd(cfd); fd_stat(cfd); errno = e; }
+  return cfd;
+}
+
+// dup 류로 생긴 FD: 슬롯은 따로 세되 (처음 쓸 때 판별) 연결 수에는 원래 FD 만 센다
+static void dup_fd(int oldfd, int newfd){
+  if (newfd < 0 || newfd >= NP_MAX_FD) return;
+  int e = errno;
+  retire_fd(newfd);
+  if (fd_stat(oldfd)) __atomic_store_n(&D_dup[newfd], 1, __ATOMIC_RELAXED);
+  errno = e;
+}
+
+int dup(int oldfd){
+  ENSURE(real_dup, "dup");
+  int r = real_dup(oldfd);
+  if (r >= 0) dup_fd(oldfd, r);
+  return r;
+}
+
+// dup2/dup3 는 newfd 를 암묵적으로 닫는다 (dup_fd 의 retire_fd 가 그 close 몫)
+int dup2(int oldfd, int newfd){
+  ENSURE(real_dup2, "dup2");
+  int r = real_dup2(oldfd, newfd);
+  if (r >= 0 && oldfd != newfd) dup_fd(oldfd, newfd);
+  return r;
+}
+
+int dup3(int oldfd, int newfd, int flags){
+  ENSURE(real_dup3, "dup3");
+  int r = real_dup3(oldfd, newfd, flags);
+  if (r >= 0) dup_fd(oldfd, newfd);
+  return r;
+}
+
+int close(int fd){
+  ENSURE(real_close, "close");
+  retire_fd(fd);   // 닫기 전에 옮긴다 (닫은 직후 다른 스레드가 같은 FD를 받을 수 있음)
+  return real_close(fd);
+}
 #endif /* RUNTIME */
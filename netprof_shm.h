@@ -0,0 +1,68 @@
+// netprof 공유 메모리 배치 (libnetprof.so 가 쓰고 netprof_top 이 읽음)
+//
+// 세그먼트 이름: /netprof.<pid>  (NETPROF_SHM 으로 바꿀 수 있음, /dev/shm 아래에 보임)
+// 카운터는 후킹 함수가 이 메모리에 바로 원자적으로 더한다 (복사/보고 단계 없음).
+// 슬롯의 정체(어떤 연결인지: state, peer, t0)가 바뀔 때는 seq 를 홀수로 만들었다가 짝수로 되돌린다.
+// 읽는 쪽은 seq 를 읽고 → 내용 복사 → seq 를 다시 읽어, 홀수거나 달라졌으면 다시 읽는다 (seqlock).
+// seq 가 달라졌다는 건 그 사이 close 되고 FD가 재사용됐다는 뜻이기도 하다.
+// TCP 표본(tcp)은 보고 스레드 혼자 주기마다 getsockopt(TCP_INFO) 로 채우며, 따로 tcp_seq 로 보호한다.
+#ifndef NETPROF_SHM_H
+#define NETPROF_SHM_H
+
+#include <stdint.h>
+
+#define NP_MAGIC    0x4650504eu   // "NPPF"
+#define NP_VERSION  2
+#define NP_MAX_FD   65536         // 슬롯 수 (이보다 큰 FD는 추적하지 않음)
+#define NP_SHARDS   64            // 닫힌 연결 합계 샤드 수 (2의 거듭제곱)
+
+enum { NP_FD_UNKNOWN, NP_FD_PENDING, NP_FD_NOT_SOCKET, NP_FD_SOCKET };
+
+// 마지막 TCP_INFO 표본 (누적값은 커널이 센 연결 시작부터의 값)
+typedef struct {
+    uint64_t sample_ns;          // 표본 시각 (CLOCK_MONOTONIC)
+    uint64_t delivery_rate;      // 최근 전달 속도 추정 (바이트/초)
+    uint64_t busy_us;            // 보낼 데이터가 있던 누적 시간
+    uint64_t rwnd_limited_us;    // 그중 상대 수신 윈도에 막힌 시간
+    uint64_t sndbuf_limited_us;  // 그중 송신 버퍼가 모자랐던 시간
+    uint32_t rtt_us, rttvar_us;  // 평활 RTT / 편차
+    uint32_t snd_cwnd, snd_mss;  // 혼잡 윈도(세그먼트 수), MSS
+    uint32_t total_retrans;      // 누적 재전송 세그먼트
+    uint32_t rcv_space;          // 수신 쪽 자동 조정 윈도 추정 (바이트)
+    uint32_t app_limited;        // 전달 속도 표본이 앱 때문에 제한됐으면 1
+    uint32_t pad;
+} np_tcp_t;
+
+typedef struct {
+    uint32_t seq;          // seqlock (홀수 = 갱신 중)
+    uint32_t state;        // NP_FD_*
+    uint64_t in_bytes;     // 누적 수신
+    uint64_t out_bytes;    // 누적 송신
+    uint64_t in_calls;
+    uint64_t out_calls;
+    uint64_t t0_ns;        // 처음 본 시각 (CLOCK_MONOTONIC)
+    uint32_t tcp_seq;      // tcp 의 seqlock
+    uint32_t tcp_ok;       // tcp 에 유효한 표본이 있으면 1 (TCP 가 아니면 0)
+    uint8_t  pad[8];
+    char     peer[64];     // 처음 볼 때 조회한 상대 주소 (문자열)
+    np_tcp_t tcp;
+} __attribute__((aligned(64))) np_slot_t;
+
+typedef struct {
+    uint64_t in_bytes, out_bytes, conns;
+} __attribute__((aligned(64))) np_shard_t;
+
+typedef struct {
+    uint32_t   magic;
+    uint32_t   version;
+    uint32_t   pid;
+    uint32_t   nslots;
+    int32_t    max_fd;     // 지금까지 본 가장 큰 소켓 FD (읽는 쪽 순회 범위)
+    uint32_t   slot_size;
+    uint64_t   t0_ns;      // 라이브러리 시작 시각
+    uint8_t    pad[32];
+    np_shard_t closed[NP_SHARDS];
+    np_slot_t  slot[NP_MAX_FD];
+} np_shm_t;
+
+#endif
@@ -0,0 +1,214 @@
+// build:  make netprof_top
+// run  :  ./netprof_top <pid>                 (LD_PRELOAD=./libnetprof.so 로 띄운 프로세스)
+//         ./netprof_top -i 500 -r 20 <pid>    (0.5초마다, 상위 20개 연결)
+//         ./netprof_top -s /이름               (NETPROF_SHM 으로 이름을 정한 경우)
+//
+// 대상 프로세스가 공유 메모리에 올려 둔 카운터를 읽기 전용으로 붙어서 읽고,
+// 연결별 처리량 표를 top 처럼 주기적으로 다시 그린다. 대상 프로세스에는 아무것도 하지 않는다.
+// 슬롯은 seqlock 으로 읽는다 (netprof_shm.h). TCP 열(RTT, CWND, RETR, DLV)은 netprof 보고 스레드가
+// 주기마다 뜬 TCP_INFO 표본이라 NETPROF_INTERVAL_MS 만큼 늦을 수 있다 (NETPROF_TCPINFO=0 이면 "-").
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "netprof_shm.h"
+
+typedef struct {
+    int      fd;
+    uint32_t seq;
+    uint64_t in_bytes, out_bytes, in_calls, out_calls, t0_ns;
+    char     peer[64];
+    double   in_rate, out_rate;   // 이번 주기 MB/s
+    int      tcp_ok;
+    np_tcp_t tcp;
+} row_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// TCP 표본 복사 (tcp_seq 로 따로 보호). 끝내 못 읽으면 표본 없음으로
+static void read_tcp(const np_slot_t* s, row_t* r) {
+    r->tcp_ok = 0;
+    for (int tries = 0; tries < 100; tries++) {
+        uint32_t seq = __atomic_load_n(&s->tcp_seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) continue;
+        int ok = __atomic_load_n(&s->tcp_ok, __ATOMIC_RELAXED);
+        memcpy(&r->tcp, &s->tcp, sizeof(r->tcp));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->tcp_seq, __ATOMIC_RELAXED) != seq) continue;
+        r->tcp_ok = ok;
+        return;
+    }
+}
+
+// 슬롯 하나를 일관되게 복사 (쓰는 중이면 다시 읽음). 소켓 슬롯이 아니면 0
+static int read_slot(const np_slot_t* s, int fd, row_t* r) {
+    for (int tries = 0; tries < 100; tries++) {
+        uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) continue;
+        uint32_t state = __atomic_load_n(&s->state, __ATOMIC_ACQUIRE);
+        r->in_bytes  = __atomic_load_n(&s->in_bytes,  __ATOMIC_RELAXED);
+        r->out_bytes = __atomic_load_n(&s->out_bytes, __ATOMIC_RELAXED);
+        r->in_calls  = __atomic_load_n(&s->in_calls,  __ATOMIC_RELAXED);
+        r->out_calls = __atomic_load_n(&s->out_calls, __ATOMIC_RELAXED);
+        r->t0_ns     = s->t0_ns;
+        memcpy(r->peer, s->peer, sizeof(r->peer));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != seq) continue;
+        r->peer[sizeof(r->peer) - 1] = '\0';
+        r->fd  = fd;
+        r->seq = seq;
+        if (state != NP_FD_SOCKET) return 0;
+        read_tcp(s, r);
+        return 1;
+    }
+    return 0;
+}
+
+static int cmp_rate(const void* a, const void* b) {
+    const row_t* x = a;
+    const row_t* y = b;
+    double dx = x->in_rate + x->out_rate, dy = y->in_rate + y->out_rate;
+    if (dx != dy) return dx < dy ? 1 : -1;
+    return x->fd - y->fd;
+}
+
+int main(int argc, char* argv[]) {
+    int interval_ms = 1000, max_rows = 40, count = 0;
+    char name[64] = "";
+    int opt;
+    while ((opt = getopt(argc, argv, "i:r:n:s:")) != -1) {
+        switch (opt) {
+        case 'i': interval_ms = atoi(optarg); break;
+        case 'r': max_rows    = atoi(optarg); break;
+        case 'n': count       = atoi(optarg); break;   // 0 = 끝없이
+        case 's': snprintf(name, sizeof(name), "%s", optarg); break;
+        default:
+usage:
+            fprintf(stderr, "사용법: %s [-i 주기ms] [-r 행수] [-n 횟수] (pid | -s 공유메모리이름)\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!name[0]) {
+        if (optind >= argc) goto usage;
+        snprintf(name, sizeof(name), "/netprof.%d", atoi(argv[optind]));
+    }
+    if (interval_ms <= 0) interval_ms = 1000;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "%s 열기 실패: %s (LD_PRELOAD=./libnetprof.so 로 실행 중인지 확인)\n",
+                name, strerror(errno));
+        return 1;
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) < 0 || (size_t)sb.st_size < sizeof(np_shm_t)) {
+        fprintf(stderr, "%s: 크기가 맞지 않음 (버전이 다른 netprof?)\n", name);
+        return 1;
+    }
+    const np_shm_t* m = mmap(NULL, sizeof(np_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        perror("mmap 실패");
+        return 1;
+    }
+    if (__atomic_load_n(&m->magic, __ATOMIC_ACQUIRE) != NP_MAGIC || m->version != NP_VERSION ||
+        m->slot_size != sizeof(np_slot_t)) {
+        fprintf(stderr, "%s: netprof 공유 메모리가 아니거나 버전이 다름\n", name);
+        return 1;
+    }
+
+    row_t*    rows  = calloc(NP_MAX_FD, sizeof(row_t));
+    uint32_t* pseq  = calloc(NP_MAX_FD, sizeof(uint32_t));   // 직전 주기 값 (FD별)
+    uint64_t* pin   = calloc(NP_MAX_FD, sizeof(uint64_t));
+    uint64_t* pout  = calloc(NP_MAX_FD, sizeof(uint64_t));
+    if (!rows || !pseq || !pin || !pout) {
+        perror("calloc 실패");
+        return 1;
+    }
+
+    int tty = isatty(STDOUT_FILENO);
+    uint64_t prev_t = now_ns(), prev_tin = 0, prev_tout = 0;
+    int first = 1;
+    for (int iter = 0; count == 0 || iter <= count; iter++) {
+        uint64_t t = now_ns();
+        double dt = (t - prev_t) / 1e9;
+        if (dt <= 0) dt = 1e-9;
+
+        int n = 0, maxfd = __atomic_load_n(&m->max_fd, __ATOMIC_RELAXED);
+        uint64_t tin = 0, tout = 0, closed = 0;
+        for (int i = 0; i <= maxfd && i < NP_MAX_FD; i++) {
+            row_t* r = &rows[n];
+            if (!read_slot(&m->slot[i], i, r)) continue;
+            // 직전 주기와 같은 연결이면 차이로, 새 연결이면 지금까지 받은 양으로 속도를 잰다
+            uint64_t bi = pseq[i] == r->seq ? pin[i]  : 0;
+            uint64_t bo = pseq[i] == r->seq ? pout[i] : 0;
+            r->in_rate  = (r->in_bytes  - bi) / (1024.0 * 1024.0) / dt;
+            r->out_rate = (r->out_bytes - bo) / (1024.0 * 1024.0) / dt;
+            pseq[i] = r->seq; pin[i] = r->in_bytes; pout[i] = r->out_bytes;
+            tin += r->in_bytes;
+            tout += r->out_bytes;
+            n++;
+        }
+        for (int i = 0; i < NP_SHARDS; i++) {
+            tin    += __atomic_load_n(&m->closed[i].in_bytes,  __ATOMIC_RELAXED);
+            tout   += __atomic_load_n(&m->closed[i].out_bytes, __ATOMIC_RELAXED);
+            closed += __atomic_load_n(&m->closed[i].conns,     __ATOMIC_RELAXED);
+        }
+        qsort(rows, (size_t)n, sizeof(row_t), cmp_rate);
+
+        // 첫 화면은 직전 값이 없어 속도가 의미 없으므로 그리지 않는다
+        if (!first) {
+            if (tty) printf("\033[H\033[2J");
+            double up = (t - m->t0_ns) / 1e9;
+            double ri = tin  > prev_tin  ? (tin  - prev_tin)  / (1024.0 * 1024.0) / dt : 0.0;
+            double ro = tout > prev_tout ? (tout - prev_tout) / (1024.0 * 1024.0) / dt : 0.0;
+            printf("netprof_top  pid %u  uptime %.1fs  열린 연결 %d  닫힌 연결 %llu\n",
+                   m->pid, up, n, (unsigned long long)closed);
+            printf("전체  IN %10.2f MB/s (%.2f MB)   OUT %10.2f MB/s (%.2f MB)\n\n",
+                   ri, tin / (1024.0 * 1024.0), ro, tout / (1024.0 * 1024.0));
+            printf("%6s  %-24s %10s %10s %12s %12s %10s %10s %8s %8s %6s %6s %9s\n", "FD", "PEER",
+                   "IN MB/s", "OUT MB/s", "IN MB", "OUT MB", "IN calls", "OUT calls", "AGE s",
+                   "RTT ms", "CWND", "RETR", "DLV MB/s");
+            for (int i = 0; i < n && i < max_rows; i++) {
+                const row_t* r = &rows[i];
+                printf("%6d  %-24s %10.2f %10.2f %12.2f %12.2f %10llu %10llu %8.1f",
+                       r->fd, r->peer, r->in_rate, r->out_rate,
+                       r->in_bytes / (1024.0 * 1024.0), r->out_bytes / (1024.0 * 1024.0),
+                       (unsigned long long)r->in_calls, (unsigned long long)r->out_calls,
+                       (t - r->t0_ns) / 1e9);
+                if (r->tcp_ok)
+                    printf(" %8.2f %6u %6u %9.2f\n", r->tcp.rtt_us / 1e3, r->tcp.snd_cwnd,
+                           r->tcp.total_retrans, r->tcp.delivery_rate / (1024.0 * 1024.0));
+                else
+                    printf(" %8s %6s %6s %9s\n", "-", "-", "-", "-");
+            }
+            if (n > max_rows) printf("  ... 외 %d개\n", n - max_rows);
+            if (!tty) printf("\n");
+            fflush(stdout);
+        }
+        first = 0;
+        prev_t = t; prev_tin = tin; prev_tout = tout;
+
+        if (kill((pid_t)m->pid, 0) < 0 && errno == ESRCH) {
+            printf("pid %u 종료됨\n", m->pid);
+            break;
+        }
+        if (count && iter == count) break;
+        struct timespec ts = { interval_ms / 1000, (interval_ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+    return 0;
+}
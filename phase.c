@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "phase.h"
+
+enum { P_OFF, P_JSON, P_CSV };
+
+static int   g_fmt = P_OFF;
+static FILE* g_out;
+
+uint64_t phase_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int phase_open(const char* fmt, const char* path) {
+    if (strcmp(fmt, "json") == 0)     g_fmt = P_JSON;
+    else if (strcmp(fmt, "csv") == 0) g_fmt = P_CSV;
+    else {
+        fprintf(stderr, "알 수 없는 기록 형식: %s (json|csv)\n", fmt);
+        return -1;
+    }
+    g_out = stderr;
+    if (path && *path && strcmp(path, "-") != 0 && !(g_out = fopen(path, "a"))) {
+        perror("단계 기록 파일 열기 실패");
+        g_fmt = P_OFF;
+        return -1;
+    }
+    setvbuf(g_out, NULL, _IOLBF, 0);   // 한 줄씩 바로 (tail -f 로 볼 수 있게)
+    fseek(g_out, 0, SEEK_END);
+    if (g_fmt == P_CSV && ftell(g_out) <= 0)   // 새 파일(또는 stderr)이면 머리줄
+        fprintf(g_out, "client,engine,conn,req,mb,bytes,new_conn,socket_ns,connect_ns,sent_ns,first_ns,last_ns,"
+                       "connect_ms,ttfb_ms,xfer_ms,total_ms,rtt_ms,xfer_mbps,dominant\n");
+    return 0;
+}
+
+int phase_enabled(void) {
+    return g_fmt != P_OFF;
+}
+
+uint64_t phase_wait_first(int sock) {
+    if (g_fmt == P_OFF) return phase_now();
+    struct pollfd pfd = { sock, POLLIN, 0 };
+    while (poll(&pfd, 1, -1) < 0 && errno == EINTR) {}
+    return phase_now();
+}
+
+static double ms(uint64_t from, uint64_t to) {
+    return to > from ? (to - from) / 1e6 : 0.0;
+}
+
+void phase_emit(const phase_t* p, const char* client, const char* engine, int conn,
+                long long req, long long mb, int sock) {
+    if (g_fmt == P_OFF) return;
+
+    // 커널이 잰 평활 RTT: ttfb 에서 이만큼을 빼면 대략 서버 처리 시간
+    double rtt = 0.0;
+    struct tcp_info ti;
+    socklen_t len = sizeof(ti);
+    if (sock >= 0 && getsockopt(sock, IPPROTO_TCP, TCP_INFO, &ti, &len) == 0) rtt = ti.tcpi_rtt / 1000.0;
+
+    double c_ms = ms(p->socket_ns, p->connect_ns);
+    double t_ms = ms(p->sent_ns, p->first_ns);    // 요청 → 첫 바이트 (RTT + 서버 처리)
+    double x_ms = ms(p->first_ns, p->last_ns);    // 첫 바이트 → 마지막 바이트 (대역폭)
+    double all  = (p->new_conn ? c_ms : 0.0) + ms(p->sent_ns, p->last_ns);
+    double mbps = x_ms > 0.0 ? p->bytes / (1024.0 * 1024.0) / (x_ms / 1000.0) : 0.0;
+
+    // 가장 오래 걸린 단계 (연결 시간은 이 요청이 연결을 연 경우만)
+    const char* dom = "transfer";
+    if (t_ms > x_ms) dom = "ttfb";
+    if (p->new_conn && c_ms > t_ms && c_ms > x_ms) dom = "connect";
+
+    if (g_fmt == P_JSON)
+        fprintf(g_out, "{\"client\":\"%s\",\"engine\":\"%s\",\"conn\":%d,\"req\":%lld,\"mb\":%lld,"
+                       "\"bytes\":%lld,\"new_conn\":%d,\"socket_ns\":%llu,\"connect_ns\":%llu,"
+                       "\"sent_ns\":%llu,\"first_ns\":%llu,\"last_ns\":%llu,\"connect_ms\":%.3f,"
+                       "\"ttfb_ms\":%.3f,\"xfer_ms\":%.3f,\"total_ms\":%.3f,\"rtt_ms\":%.3f,"
+                       "\"xfer_mbps\":%.2f,\"dominant\":\"%s\"}\n",
+                client, engine, conn, req, mb, p->bytes, p->new_conn,
+                (unsigned long long)p->socket_ns, (unsigned long long)p->connect_ns,
+                (unsigned long long)p->sent_ns, (unsigned long long)p->first_ns,
+                (unsigned long long)p->last_ns, c_ms, t_ms, x_ms, all, rtt, mbps, dom);
+    else
+        fprintf(g_out, "%s,%s,%d,%lld,%lld,%lld,%d,%llu,%llu,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%s\n",
+                client, engine, conn, req, mb, p->bytes, p->new_conn,
+                (unsigned long long)p->socket_ns, (unsigned long long)p->connect_ns,
+                (unsigned long long)p->sent_ns, (unsigned long long)p->first_ns,
+                (unsigned long long)p->last_ns, c_ms, t_ms, x_ms, all, rtt, mbps, dom);
+}
@@ -0,0 +1,33 @@
+// 요청 하나의 단계별 시각 기록: 소켓 생성 → 연결 완료 → 요청 전송 → 첫 바이트 → 마지막 바이트.
+// 요청마다 JSON 또는 CSV 한 줄로 내보내, 느린 다운로드가 RTT / 서버 / 대역폭 중 어디에 묶였는지 본다.
+// 시각은 모두 CLOCK_MONOTONIC 나노초. (client_stream, recv_client 가 같이 씀)
+#ifndef PHASE_H
+#define PHASE_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint64_t  socket_ns;    // socket() 호출 직전
+    uint64_t  connect_ns;   // connect() 완료
+    uint64_t  sent_ns;      // 요청 전송 완료
+    uint64_t  first_ns;     // 첫 바이트 도착 (poll 로 읽을 수 있게 된 시각)
+    uint64_t  last_ns;      // 마지막 바이트 수신
+    long long bytes;
+    int       new_conn;     // 이 연결의 첫 요청이면 1 (연결 시간이 이 요청의 지연에 들어감)
+} phase_t;
+
+uint64_t phase_now(void);
+
+// 기록 시작: fmt = "json" | "csv", path 가 NULL 이거나 "-" 면 stderr. 성공 0, 실패 -1
+int  phase_open(const char* fmt, const char* path);
+int  phase_enabled(void);
+
+// 소켓에 읽을 데이터가 생길 때까지 기다려 그 시각을 돌려준다 (기록을 안 하면 기다리지 않고 현재 시각).
+// 수신 방식(엔진)과 상관없이 첫 바이트 시각을 잴 수 있다
+uint64_t phase_wait_first(int sock);
+
+// 한 줄 출력. sock 이 살아 있으면 TCP_INFO 의 RTT 도 같이 적는다
+void phase_emit(const phase_t* p, const char* client, const char* engine, int conn,
+                long long req, long long mb, int sock);
+
+#endif
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "progress.h"
+
+#define MB (1024.0 * 1024.0)
+#define GB (1024.0 * 1024.0 * 1024.0)
+
+double progress_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+long long progress_counter(void* arg) {
+    return __atomic_load_n((long long*)arg, __ATOMIC_RELAXED);
+}
+
+// 크기를 읽기 좋게 (1GB 이상이면 GB)
+static void fmt_size(char* out, size_t len, double bytes) {
+    if (bytes >= GB) snprintf(out, len, "%.2f GB", bytes / GB);
+    else             snprintf(out, len, "%.1f MB", bytes / MB);
+}
+
+static void* progress_main(void* arg) {
+    progress_t* p = arg;
+    long long prev = p->get(p->arg);
+    double    prev_t = p->t0;
+
+    pthread_mutex_lock(&p->mu);
+    while (!p->stop) {
+        struct timespec dl;
+        clock_gettime(CLOCK_MONOTONIC, &dl);
+        long long ns = dl.tv_nsec + (long long)(p->interval * 1e9);
+        dl.tv_sec  += ns / 1000000000LL;
+        dl.tv_nsec  = ns % 1000000000LL;
+        if (pthread_cond_timedwait(&p->cv, &p->mu, &dl) == 0 || p->stop) continue;
+
+        long long cur = p->get(p->arg);
+        double t = progress_now();
+        double inst = t > prev_t ? (cur - prev) / MB / (t - prev_t) : 0.0;
+        double avg  = t > p->t0 ? cur / MB / (t - p->t0) : 0.0;
+        char got[32], tot[32];
+        fmt_size(got, sizeof(got), (double)cur);
+        if (p->total > 0) {
+            fmt_size(tot, sizeof(tot), (double)p->total);
+            double eta = avg > 0.0 ? (p->total - cur) / MB / avg : 0.0;
+            fprintf(stderr, "  진행 %s / %s (%.1f%%)  현재 %.2f MB/s  평균 %.2f MB/s  남은 시간 %.0f초\n",
+                    got, tot, cur * 100.0 / p->total, inst, avg, eta);
+        } else {
+            fprintf(stderr, "  진행 %s  현재 %.2f MB/s  평균 %.2f MB/s\n", got, inst, avg);
+        }
+        prev = cur;
+        prev_t = t;
+    }
+    pthread_mutex_unlock(&p->mu);
+    return NULL;
+}
+
+void progress_start(progress_t* p, progress_get_fn get, void* arg, long long total, double interval) {
+    const char* env = getenv("PROGRESS_SEC");
+    if (env && *env) interval = atof(env);
+    p->running = 0;
+    if (interval <= 0) return;
+
+    p->get      = get;
+    p->arg      = arg;
+    p->total    = total;
+    p->interval = interval;
+    p->stop     = 0;
+    p->t0       = progress_now();
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&p->cv, &ca);
+    pthread_condattr_destroy(&ca);
+    pthread_mutex_init(&p->mu, NULL);
+    if (pthread_create(&p->tid, NULL, progress_main, p) != 0) {
+        perror("진행 표시 스레드 생성 실패");
+        return;
+    }
+    p->running = 1;
+}
+
+void progress_stop(progress_t* p) {
+    if (!p->running) return;
+    pthread_mutex_lock(&p->mu);
+    p->stop = 1;
+    pthread_cond_signal(&p->cv);
+    pthread_mutex_unlock(&p->mu);
+    pthread_join(p->tid, NULL);
+    pthread_cond_destroy(&p->cv);
+    pthread_mutex_destroy(&p->mu);
+    p->running = 0;
+}
@@ -0,0 +1,35 @@
+// 긴 전송의 진행 상황 출력: 별도 스레드가 주기마다 받은 바이트 수를 읽어 stderr 에 한 줄씩 쓴다.
+// 수신 루프(엔진)는 건드리지 않고 카운터만 읽으므로 어떤 수신 방식과도 같이 쓸 수 있다.
+// (client_stream, recv_client, staticclient 가 같이 씀)
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <pthread.h>
+
+// 지금까지 받은 바이트 수를 돌려주는 함수 (수신 스레드가 쓰는 중에 읽으므로 원자적으로 읽을 것)
+typedef long long (*progress_get_fn)(void* arg);
+
+typedef struct {
+    pthread_t       tid;
+    int             running;
+    int             stop;
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;
+    progress_get_fn get;
+    void*           arg;
+    long long       total;      // 전체 크기 (0 이면 모름)
+    double          interval;   // 출력 주기(초)
+    double          t0;
+} progress_t;
+
+// 단조 시계(초). 벽시계와 달리 NTP 보정 등으로 뒤로 가지 않아 긴 전송의 경과 시간에 쓴다
+double progress_now(void);
+
+// 주기 interval 초로 시작 (interval <= 0 이면 아무것도 안 함). env PROGRESS_SEC 가 있으면 그 값 사용
+void progress_start(progress_t* p, progress_get_fn get, void* arg, long long total, double interval);
+void progress_stop(progress_t* p);
+
+// 흔한 경우: long long 카운터 하나를 읽는 get 함수 (arg = long long*)
+long long progress_counter(void* arg);
+
+#endif
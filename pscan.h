@@ -0,0 +1,46 @@
+// 다중 패턴 스트리밍 스캐너: 여러 바이트열을 한 번에 찾고, read 경계에 걸친 일치도 찾는다.
+// 후보 걸러내기는 패턴의 첫/끝 바이트를 SIMD(SSE2/AVX2)로 동시에 비교하고, 후보만 memcmp 로 확인.
+// (myread.so 와 scanbench 가 같이 씀)
+#ifndef PSCAN_H
+#define PSCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PSCAN_MAX_PATTERNS 16
+#define PSCAN_MAX_LEN      64
+
+// 일치 하나: pat = 패턴 번호, off = 스트림 처음부터의 절대 위치
+typedef void (*pscan_cb)(void* arg, int pat, uint64_t off);
+
+typedef struct {
+    int     n;                                   // 패턴 수
+    int     maxlen;
+    int     len[PSCAN_MAX_PATTERNS];
+    uint8_t pat[PSCAN_MAX_PATTERNS][PSCAN_MAX_LEN];
+    char    text[PSCAN_MAX_PATTERNS][PSCAN_MAX_LEN * 4 + 1];   // 출력용 (비인쇄 문자는 \xNN)
+    // buf[0..n) 에서 lo_end < 시작+길이, 시작 < hi_start 인 일치를 base+시작 으로 보고
+    void  (*scan)(const void* ps, const uint8_t* buf, size_t n, size_t lo_end, size_t hi_start,
+                  uint64_t base, pscan_cb cb, void* arg);
+    const char* impl;                            // 선택된 구현 이름
+} pscan_t;
+
+// FD(스트림)별 상태: 지금까지 본 바이트 수와, 다음 read 와 이어 볼 마지막 maxlen-1 바이트
+typedef struct {
+    uint64_t pos;
+    int      tail_len;
+    uint8_t  tail[PSCAN_MAX_LEN];
+} pscan_stream_t;
+
+// 패턴 목록 "Z,ABC,\x00\xff" 해석 (쉼표 구분, \xNN \, \\ 이스케이프). 성공 0, 실패 -1
+int  pscan_init(pscan_t* ps, const char* spec);
+
+// 구현 선택: "auto" | "avx2" | "sse2" | "memchr". CPU가 지원하지 않으면 -1
+// auto: 패턴 하나면 memchr, 여럿이면 avx2 → sse2 → memchr 중 CPU가 되는 첫 번째
+int  pscan_set_impl(pscan_t* ps, const char* name);
+
+// 스트림에 새 데이터 buf[0..n) 를 이어 붙여 검사 (이전 데이터와 걸친 일치 포함)
+void pscan_feed(const pscan_t* ps, pscan_stream_t* st, const uint8_t* buf, size_t n,
+                pscan_cb cb, void* arg);
+
+#endif
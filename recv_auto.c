@@ -0,0 +1,174 @@
+// auto 수신 엔진: 전송 앞부분에서 설정을 바꿔 가며 측정하고, 가장 빠른 설정으로 고정
+//
+// 조정 대상 (한 번에 하나씩, 앞 단계의 최선을 유지한 채 다음 단계를 탐색)
+//   1단계: 사용자 공간 청크 크기 (read 한 번에 요청하는 양)
+//   2단계: SO_RCVBUF (0 = 커널 자동 조정 그대로)
+//   3단계: SO_RCVLOWAT (read가 깨어나기 위한 최소 수신량)
+// 후보마다 AUTO_PROBE_BYTES씩 받아 MB/s와 호출당 바이트를 재고, MB/s가 가장 높은 설정을 고른다.
+// 탐색은 전송량의 1/AUTO_PROBE_SHARE 안에서만 하며, 끝까지 탐색한 설정은 소켓별로 기억해
+// 같은 연결의 다음 요청부터는 탐색 없이 바로 쓴다. 새 연결이 같은 fd 번호를 받아도 물려받지 않도록
+// client_connect 가 recv_auto_forget 으로 기억을 지운다 (-R 재연결 등).
+// 요청이 끝나면 SO_RCVLOWAT 은 1 로 되돌려, 같은 소켓에서 다른 엔진을 쓰는 요청(-e all)에 남지 않게 한다.
+//
+// 참고: 연결 후 SO_RCVBUF를 바꾸면 이미 협상된 윈도 스케일 안에서만 효과가 있고,
+//       한 번 설정하면 커널 자동 조정이 꺼진다. 그래서 기본값(0)을 항상 먼저 잰다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+
+#include "recv_engine.h"
+
+#define AUTO_MAX_CHUNK   (1024 * 1024)
+#define AUTO_PROBE_BYTES (1024 * 1024)   // 후보 하나당 측정 구간
+#define AUTO_PROBE_SHARE 4               // 전송량의 1/4 까지만 탐색에 사용
+
+typedef struct {
+    int chunk;    // read 요청 크기
+    int rcvbuf;   // SO_RCVBUF (0이면 건드리지 않음)
+    int lowat;    // SO_RCVLOWAT
+} tune_t;
+
+static const int chunk_cand[]  = { 4096, 16384, 65536, 262144, 1048576 };
+static const int rcvbuf_cand[] = { 0, 1 << 20, 4 << 20, 16 << 20 };
+
+// 마지막으로 탐색을 끝낸 소켓과 그 결과
+static int    g_tuned_sock = -1;
+static tune_t g_tuned;
+
+void recv_auto_forget(int sock) {
+    if (sock == g_tuned_sock) g_tuned_sock = -1;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void apply(int sock, const tune_t* t) {
+    if (t->rcvbuf > 0) setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &t->rcvbuf, sizeof(t->rcvbuf));
+    setsockopt(sock, SOL_SOCKET, SO_RCVLOWAT, &t->lowat, sizeof(t->lowat));
+}
+
+// t 설정으로 최대 limit 바이트를 받아 파일에 쓴다. 받은 바이트 수 반환, EOF/오류면 -1
+static long long recv_with(int sock, FILE* fp, char* buf, const tune_t* t,
+                           long long limit, recv_stat_t* st, long* calls) {
+    long long got = 0;
+    while (got < limit) {
+        size_t want = (size_t)t->chunk;
+        if (limit - got < (long long)want) want = (size_t)(limit - got);
+        ssize_t n = read(sock, buf, want);
+        if (n < 0 && errno == EINTR) continue;   // 시그널로 끊긴 것은 다시 읽는다
+        if (n <= 0) return -1;
+        recv_sum(st, buf, (size_t)n);
+        fwrite(buf, 1, (size_t)n, fp);
+        got       += n;
+        recv_add(st, n);
+        st->calls += 2;
+        (*calls)++;
+    }
+    return got;
+}
+
+// 후보 하나 측정: 성공하면 MB/s, EOF/오류면 -1
+static double probe(int sock, FILE* fp, char* buf, const tune_t* t,
+                    long long size, recv_stat_t* st) {
+    long long win = AUTO_PROBE_BYTES;
+    if (size - st->bytes < win) win = size - st->bytes;
+    long calls = 0;
+
+    apply(sock, t);
+    double t0 = now_s();
+    if (recv_with(sock, fp, buf, t, win, st, &calls) < 0) return -1.0;
+    double el = now_s() - t0;
+    double mbps = el > 0 ? (win / (1024.0 * 1024.0)) / el : 0.0;
+
+    fprintf(stderr, "[auto]   chunk=%-7d rcvbuf=%-8d lowat=%-7d → %8.2f MB/s, %8.0f B/call\n",
+            t->chunk, t->rcvbuf, t->lowat, mbps, calls ? (double)win / calls : 0.0);
+    return mbps;
+}
+
+static void auto_run(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    static char* buf = NULL;   // 가장 큰 청크 하나를 계속 재사용
+    if (!buf && !(buf = malloc(AUTO_MAX_CHUNK))) {
+        perror("malloc 실패");
+        return;
+    }
+
+    tune_t best = { BLOCK_SIZE, 0, 1 };
+    if (sock == g_tuned_sock) {
+        best = g_tuned;
+    } else {
+        long long budget = size / AUTO_PROBE_SHARE;   // 탐색에 쓸 수 있는 양
+        double best_rate = -1.0, r;
+        int complete = 0;
+        int auto_rcvbuf = 0, rcvbuf_set = 0;   // 자동 조정된 SO_RCVBUF, 후보를 하나라도 설정했는지
+        tune_t cur = best;
+
+        fprintf(stderr, "[auto] fd=%d 탐색 시작 (최대 %lld 바이트)\n", sock, budget);
+
+        // 첫 바이트가 올 때까지의 대기(RTT + 서버 처리)가 첫 후보 측정에 섞이지 않도록
+        // 측정 없이 한 블록 먼저 받는다
+        long warm = 0;
+        if (recv_with(sock, fp, buf, &cur, size < BLOCK_SIZE ? size : BLOCK_SIZE, st, &warm) < 0) return;
+
+        // 1단계: 청크 크기
+        for (size_t i = 0; i < sizeof(chunk_cand) / sizeof(chunk_cand[0]); i++) {
+            if (st->bytes + AUTO_PROBE_BYTES > budget) goto stop;
+            cur.chunk = chunk_cand[i];
+            if ((r = probe(sock, fp, buf, &cur, size, st)) < 0) return;
+            if (r > best_rate) { best_rate = r; best = cur; }
+        }
+
+        // 2단계: 수신 버퍼. 기본값(0)은 1단계 최선의 측정치를 그대로 쓴다
+        socklen_t len = sizeof(auto_rcvbuf);
+        getsockopt(sock, SOL_SOCKET, SO_RCVBUF, &auto_rcvbuf, &len);  // 커널 자동 조정 결과
+        cur = best;
+        for (size_t i = 1; i < sizeof(rcvbuf_cand) / sizeof(rcvbuf_cand[0]); i++) {
+            if (st->bytes + AUTO_PROBE_BYTES > budget) goto stop;
+            cur.rcvbuf = rcvbuf_cand[i];
+            rcvbuf_set = 1;
+            if ((r = probe(sock, fp, buf, &cur, size, st)) < 0) return;
+            if (r > best_rate) { best_rate = r; best = cur; }
+        }
+        // 3단계: 최소 수신량 (1 = 기본)
+        cur = best;
+        int lowat_cand[] = { best.chunk / 4, best.chunk / 2 };
+        for (size_t i = 0; i < 2; i++) {
+            if (st->bytes + AUTO_PROBE_BYTES > budget) goto stop;
+            if (lowat_cand[i] <= 1) continue;
+            cur.lowat = lowat_cand[i];
+            if ((r = probe(sock, fp, buf, &cur, size, st)) < 0) return;
+            if (r > best_rate) { best_rate = r; best = cur; }
+        }
+        complete = 1;
+stop:
+        // 기본값이 이겼는데 이미 다른 값을 설정했다면, 자동 조정이 키워 둔 크기로 되돌린다
+        // (2단계 도중 예산이 떨어져 멈춘 경우도 포함. getsockopt는 커널 내부 값(요청의 2배)을
+        //  돌려주므로 절반으로 설정)
+        if (best.rcvbuf == 0 && rcvbuf_set) best.rcvbuf = auto_rcvbuf / 2;
+        if (complete) {
+            g_tuned_sock = sock;
+            g_tuned      = best;
+        }
+        fprintf(stderr, "[auto] fd=%d %s: chunk=%d rcvbuf=%d lowat=%d (%.2f MB/s)\n",
+                sock, complete ? "설정 고정" : "전송이 짧아 탐색 중단, 현재 최선으로 진행",
+                best.chunk, best.rcvbuf, best.lowat, best_rate > 0 ? best_rate : 0.0);
+    }
+
+    // 나머지는 고른 설정으로 수신
+    long calls = 0;
+    apply(sock, &best);
+    recv_with(sock, fp, buf, &best, size - st->bytes, st, &calls);
+}
+
+void recv_auto(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    auto_run(sock, fp, size, st);
+    // 최소 수신량은 기본값으로 복구. SO_RCVBUF 는 한 번 설정하면 자동 조정으로 되돌릴 수 없어 그대로 둔다
+    int one = 1;
+    setsockopt(sock, SOL_SOCKET, SO_RCVLOWAT, &one, sizeof(one));
+}
@@ -0,0 +1,122 @@
+// 사용자 버퍼로 받는 수신 엔진들: 소켓 → 버퍼로 가져오는 시스템 콜만 다르고 나머지는 같다.
+//   read     : read() 4KB (기준선, 원래 클라이언트들의 루프)
+//   recv     : recv(MSG_WAITALL) 로 256KB 를 다 채운 뒤 돌아옴 (호출 수 최소, 대신 버퍼가 찰 때까지 대기)
+//   readv    : 64KB 버퍼 16개를 readv() 한 번으로 (큰 버퍼, 호출 수 적음)
+//   busypoll : SO_BUSY_POLL 을 켜고 논블로킹 recv 를 돌며 기다림 (잠들었다 깨는 지연 없음, CPU 한 개 소모)
+// 각 엔진은 fill(버퍼 하나 채우기)과, fill 로 받아 fwrite 하는 run 을 제공한다.
+// 파일로 받는 클라이언트는 run, 메모리로 받는 클라이언트는 fill 을 쓰므로 수신 코드는 한 벌이다.
+//
+// env  :  RECV_BUSY_POLL_US=50    (busypoll 엔진의 SO_BUSY_POLL 값, 기본 50us.
+//                                  net.core.busy_read 보다 크게 하려면 CAP_NET_ADMIN 필요, 실패해도 돌며 대기는 함)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "recv_engine.h"
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+
+ssize_t fill_read(int sock, void* buf, size_t len, recv_stat_t* st) {
+    ssize_t n;
+    do {
+        n = read(sock, buf, len);
+        st->calls++;
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+// MSG_WAITALL: len 을 다 채우거나 EOF/오류/시그널일 때만 돌아온다. 시그널로 일부만 받았으면 그만큼 반환
+ssize_t fill_recv(int sock, void* buf, size_t len, recv_stat_t* st) {
+    ssize_t n;
+    do {
+        n = recv(sock, buf, len, MSG_WAITALL);
+        st->calls++;
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+// 연속된 buf 를 READV_SEG 조각으로 나눠 한 번에 (실제 앱의 버퍼 체인처럼)
+ssize_t fill_readv(int sock, void* buf, size_t len, recv_stat_t* st) {
+    struct iovec iov[READV_NSEG];
+    int cnt = 0;
+    for (size_t off = 0; off < len && cnt < READV_NSEG; cnt++, off += READV_SEG) {
+        iov[cnt].iov_base = (char*)buf + off;
+        iov[cnt].iov_len  = len - off < READV_SEG ? len - off : READV_SEG;
+    }
+    ssize_t n;
+    do {
+        n = readv(sock, iov, cnt);
+        st->calls++;
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+// SO_BUSY_POLL 은 수신(st)마다 처음 한 번만 건다. 상태를 st 에 두므로 병렬 흐름끼리 섞이지 않고,
+// 다시 연결해 같은 FD 번호를 받아도 새 수신이면 새 소켓에 다시 설정한다
+ssize_t fill_busypoll(int sock, void* buf, size_t len, recv_stat_t* st) {
+    if (!st->sock_set) {
+        const char* env = getenv("RECV_BUSY_POLL_US");
+        int us = env && *env ? atoi(env) : 50;
+        if (setsockopt(sock, SOL_SOCKET, SO_BUSY_POLL, &us, sizeof(us)) < 0)
+            perror("SO_BUSY_POLL 설정 실패 (돌며 대기만 함)");
+        st->sock_set = 1;
+        st->calls++;
+    }
+    while (1) {
+        ssize_t n = recv(sock, buf, len, MSG_DONTWAIT);
+        st->calls++;
+        if (n >= 0) return n;
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return -1;
+    }
+}
+
+// fill 로 bufsz 씩 받아 fwrite (호출 수에 fwrite 도 하나씩 센다)
+static void fill_loop(int sock, FILE* fp, long long size, recv_stat_t* st,
+                      ssize_t (*fill)(int, void*, size_t, recv_stat_t*), char* buf, size_t bufsz) {
+    while (st->bytes < size) {
+        // 다음 응답을 미리 읽어버리지 않도록 남은 양까지만 요청 (파이프라인 모드)
+        size_t want = bufsz;
+        if (size - st->bytes < (long long)want) want = (size_t)(size - st->bytes);
+        ssize_t n = fill(sock, buf, want, st);
+        if (n <= 0) break;
+        recv_sum(st, buf, (size_t)n);   // 캐시에 있는 동안 체크섬
+        fwrite(buf, 1, (size_t)n, fp);  // 받은 만큼만 저장
+        recv_add(st, n);
+        st->calls++;
+    }
+}
+
+// 큰 버퍼를 쓰는 엔진: 요청마다 한 번 할당
+static void fill_loop_heap(int sock, FILE* fp, long long size, recv_stat_t* st,
+                           ssize_t (*fill)(int, void*, size_t, recv_stat_t*), size_t bufsz) {
+    char* buf = malloc(bufsz);
+    if (!buf) {
+        perror("수신 버퍼 할당 실패");
+        return;
+    }
+    fill_loop(sock, fp, size, st, fill, buf, bufsz);
+    free(buf);
+}
+
+void recv_read(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    char block[BLOCK_SIZE];       // 수신용 블록 버퍼
+    fill_loop(sock, fp, size, st, fill_read, block, sizeof(block));
+}
+
+void recv_waitall(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    fill_loop_heap(sock, fp, size, st, fill_recv, WAITALL_CHUNK);
+}
+
+void recv_readv(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    fill_loop_heap(sock, fp, size, st, fill_readv, (size_t)READV_SEG * READV_NSEG);
+}
+
+void recv_busypoll(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    fill_loop_heap(sock, fp, size, st, fill_busypoll, BUSY_CHUNK);
+}
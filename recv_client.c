@@ -2,30 +2,72 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <arpa/inet.h>
-#include <sys/time.h>
-#include <errno.h>
-
-#define BLOCK_SIZE 4096  // 블록 단위로 데이터 수신
-
-int main() {
-    // 1. 소켓 생성
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
+#include <time.h>
+#include <sys/socket.h>
+
+#include "recv_engine.h"  // -e 로 고를 수 있는 수신 엔진
+#include "client_core.h"  // 서버 주소 / 엔진 / 싱크 옵션과 연결
+#include "progress.h"     // 긴 전송의 진행 상황 표시
+#include "phase.h"        // -T: 요청마다 단계별 시각 기록
+
+#define MAX_MB (16LL * 1024 * 1024)   // 요청 크기 상한 16TB (MB 단위)
+
+// -q: 파이프라인 응답 하나를 received_<MB>MB_<i>.bin (싱크) 로 받는다
+static long long pipe_recv(void* arg, int sock, int idx, long long mb) {
+    const client_opt_t* co = arg;
+    char filename[64];
+    snprintf(filename, sizeof(filename), "received_%lldMB_%d.bin", mb, idx);
+    FILE* fp = client_sink_open(co, filename, "wb");
+    if (!fp) return 0;
+    recv_stat_t st = { 0, 0 };
+    progress_t pg;
+    progress_start(&pg, progress_counter, &st.bytes, mb * 1024 * 1024, 1.0);
+    co->eng->run(sock, fp, mb * 1024 * 1024, &st);
+    progress_stop(&pg);
+    fclose(fp);
+    return st.bytes;
+}
 
-    // 2. 서버 주소 설정
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(8888);
-    inet_pton(AF_INET, "115.145.211.117", &server_addr.sin_addr);  // 서버 IP 설정
+int main(int argc, char* argv[]) {
+    // 기본 엔진은 recv (MSG_WAITALL). -e 로 다른 엔진 (예: -e uring), -o 로 싱크
+    client_opt_t co;
+    client_init(&co, "recv", SINK_FILE);
+    int depth = 0;   // 파이프라인 깊이 (-q, 0이면 요청 하나씩)
+    int opt;
+    while ((opt = getopt(argc, argv, "q:T:" CLIENT_OPTS)) != -1) {
+        int rc = client_opt(&co, opt, optarg);
+        if (rc > 0) continue;
+        if (rc < 0) return 1;
+        if (opt == 'T') {   // json | csv, ":파일" 을 붙이면 파일에 (기본 stderr)
+            char* path = strchr(optarg, ':');
+            if (path) *path++ = '\0';
+            if (phase_open(optarg, path) < 0) return 1;
+            continue;
+        }
+        if (opt == 'q' && (depth = atoi(optarg)) >= 1) continue;   // 한 줄에 "10 10 10 ..." 입력
+        fprintf(stderr, "사용법: %s [-q 파이프라인깊이] [-T json|csv[:파일]]\n", argv[0]);
+        client_usage();
+        return 1;
+    }
+    const recv_engine_t* eng = co.eng;
+    if (client_check(&co, eng, 0) < 0) return 1;
+    if (depth > 0 && phase_enabled()) {
+        fprintf(stderr, "-q 는 -T 와 함께 쓸 수 없음 (단계 기록은 요청 하나씩 보낼 때만)\n");
+        return 1;
+    }
 
-    // 3. 서버에 연결 요청
-    if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+    // 1~3. 소켓 생성, 서버 연결 (-H / -p, 없으면 SERVER_IP / SERVER_PORT 환경변수)
+    phase_t conn_ph = { 0 };
+    conn_ph.socket_ns = phase_now();
+    int sock = client_connect(&co);
+    if (sock < 0) {
         perror("서버 연결 실패");
-        close(sock);
         exit(1);
     }
+    conn_ph.connect_ns = phase_now();
+    conn_ph.new_conn   = 1;
     printf("클라이언트: 서버에 연결됨\n");
+    long long nreq = 0;
 
     char send_buf[1024];  // 사용자 요청 입력 버퍼
 
@@ -40,33 +82,34 @@ int main() {
             break;
         }
 
+        if (depth > 0) {
+            client_pipe_t hook = { NULL, NULL, pipe_recv, NULL, &co };
+            client_pipeline(sock, send_buf, depth, &hook);
+            continue;
+        }
+
         // 요청 크기 해석
-        int mb = atoi(send_buf);
-        if (mb <= 0 || mb > 100) {
+        long long mb = atoll(send_buf);
+        if (mb <= 0 || mb > MAX_MB) {
             printf("클라이언트: 잘못된 요청\n");
             continue;
         }
 
-        int size = mb * 1024 * 1024;  // 바이트 단위로 변환
-        char block[BLOCK_SIZE];       // 수신용 블록 버퍼
-        int received = 0;
+        long long size = mb * 1024 * 1024;  // 바이트 단위로 변환 (2GB 이상도 넘치지 않게 64비트)
+        long long received = 0;
 
-        printf("클라이언트: %d MB 요청\n", mb);
+        printf("클라이언트: %lld MB 요청\n", mb);
 
         // 파일 이름 생성
         char filename[64];
-        snprintf(filename, sizeof(filename), "received_%dMB.bin", mb);
+        snprintf(filename, sizeof(filename), "received_%lldMB.bin", mb);
 
-        // 저장할 파일 열기
-        FILE *fp = fopen(filename, "wb");
-        if (!fp) {
-            perror("파일 열기 실패");
-            break;
-        }
+        // 저장할 파일(싱크) 열기
+        FILE *fp = client_sink_open(&co, filename, "wb");
+        if (!fp) break;
 
-        // 다운로드 시간 측정 (요청 → 수신 완료까지)
-        struct timeval start, end;
-        gettimeofday(&start, NULL);  // 요청 직전 시간 측정
+        // 다운로드 시간 측정 (요청 → 수신 완료까지, 단조 시계)
+        double start = progress_now();  // 요청 직전 시간 측정
 
         // 요청 전송 (write -> send)
         ssize_t sret = send(sock, send_buf, strlen(send_buf), 0);
@@ -75,33 +118,37 @@ int main() {
             fclose(fp);
             break;
         }
-
-        // 블록 단위로 수신하여 파일에 저장 (read -> recv)
-        while (received < size) {
-            ssize_t n = recv(sock, block, BLOCK_SIZE, 0);
-            if (n <= 0) {
-                if (n < 0 && errno == EINTR) continue;
-                break;
-            }
-            fwrite(block, 1, (size_t)n, fp);  // 받은 만큼만 저장
-            received += (int)n;
-        }
-
-        gettimeofday(&end, NULL);  // 다운로드 완료 시간 측정
+        phase_t ph = conn_ph;          // 연결 시각은 첫 요청에만 new_conn 으로 표시
+        conn_ph.new_conn = 0;
+        ph.sent_ns  = phase_now();
+        ph.first_ns = phase_wait_first(sock);
+
+        // 엔진으로 수신하여 싱크에 저장
+        recv_stat_t st = { 0, 0 };
+        progress_t pg;
+        progress_start(&pg, progress_counter, &st.bytes, size, 1.0);
+        eng->run(sock, fp, size, &st);
+        progress_stop(&pg);
+        received = st.bytes;
+        ph.last_ns = phase_now();
+        ph.bytes   = received;
+        phase_emit(&ph, "recv_client", eng->name, 0, nreq++, mb, sock);
+
+        double end = progress_now();  // 다운로드 완료 시간 측정
         fclose(fp);  // 파일 닫기
 
         // 경과 시간 계산
-        double elapsed = (end.tv_sec - start.tv_sec)
-                       + (end.tv_usec - start.tv_usec) / 1000000.0;
+        double elapsed = end - start;
 
         // 평균 속도 계산
         double mb_received = received / (1024.0 * 1024.0);
         double speed = (elapsed > 0.0) ? (mb_received / elapsed) : 0.0;
 
         // 결과 출력
-        printf(" 다운로드 완료: %.2f MB (%d 바이트)\n", mb_received, received);
+        printf(" 다운로드 완료: %.2f MB (%lld 바이트)\n", mb_received, received);
         printf("⏱ 소요 시간: %.6f 초\n", elapsed);
         printf(" 평균 속도: %.2f MB/s\n", speed);
+        printf(" 수신 방식: %s, 싱크 %s, 호출 %ld회\n", eng->name, client_sink_name(co.sink), st.calls);
     }
 
     close(sock);  // 소켓 종료
@@ -0,0 +1,84 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+
+#include "recv_engine.h"
+#include "crc32c.h"
+
+#define SPLICE_PIPE_SIZE (1024 * 1024)  // 파이프 용량 (기본 64KB → 1MB로 확장 시도)
+
+void recv_sum(recv_stat_t* st, const void* buf, size_t n) {
+    if (!st->sum) return;
+    struct timespec a, b;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    st->crc = crc32c_update(st->crc, buf, n);
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    st->sum_sec += (b.tv_sec - a.tv_sec) + (b.tv_nsec - a.tv_nsec) / 1e9;
+}
+
+// ===== splice 엔진: 소켓 → 파이프 → 파일, 사용자 공간 복사 없음 =====
+// splice는 한쪽이 반드시 파이프여야 하므로 중간에 파이프를 하나 둔다
+static void recv_splice(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    st->sum = 0;   // 데이터가 사용자 공간을 거치지 않으므로 체크섬 불가
+    int pfd[2];
+    if (pipe(pfd) < 0) {
+        perror("pipe 실패");
+        return;
+    }
+    // 파이프가 클수록 한 번의 splice로 옮기는 양이 커진다 (실패해도 기본 크기로 동작)
+    int cap = fcntl(pfd[1], F_SETPIPE_SZ, SPLICE_PIPE_SIZE);
+    if (cap <= 0) cap = 64 * 1024;
+
+    fflush(fp);  // stdio 버퍼에 남은 것이 있으면 먼저 내보냄
+    int out = fileno(fp);
+
+    while (st->bytes < size) {
+        size_t want = (size_t)cap;
+        if (size - st->bytes < (long long)want) want = (size_t)(size - st->bytes);
+
+        ssize_t n = splice(sock, NULL, pfd[1], NULL, want, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        st->calls++;
+
+        // 파이프에 들어온 만큼 전부 파일로 빼낸다
+        ssize_t left = n;
+        while (left > 0) {
+            ssize_t w = splice(pfd[0], NULL, out, NULL, (size_t)left, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) {
+                perror("splice(파이프 → 파일) 실패");
+                goto done;
+            }
+            st->calls++;
+            left -= w;
+        }
+        recv_add(st, n);
+    }
+done:
+    close(pfd[0]);
+    close(pfd[1]);
+}
+
+const recv_engine_t recv_engines[] = {
+    { "read",     "read() 4KB + fwrite (기준선)",             recv_read,     fill_read,     BLOCK_SIZE,    0 },
+    { "recv",     "recv(MSG_WAITALL) 256KB 를 다 채워 받기",  recv_waitall,  fill_recv,     WAITALL_CHUNK, 0 },
+    { "readv",    "readv() 64KB x 16 = 1MB 한 번에",          recv_readv,    fill_readv,    READV_SEG * READV_NSEG, 0 },
+    { "busypoll", "SO_BUSY_POLL + 논블로킹 recv 로 돌며 대기", recv_busypoll, fill_busypoll, BUSY_CHUNK,    0 },
+    { "splice",   "splice() 소켓→파이프→파일 (zero-copy)",   recv_splice,   NULL, 0, RE_NEED_FD },
+    { "uring",    "io_uring 등록 버퍼, 수신/쓰기 동시 진행",    recv_uring,    NULL, 0, RE_NEED_FD },
+    { "mmap",     "fallocate + mmap 한 파일로 바로 read (stdio 없음)", recv_mmap, NULL, 0, RE_NEED_FD },
+    { "wb",       "write-behind: 버퍼 풀 + 쓰기 스레드 (RECV_WB_DIRECT=1 이면 O_DIRECT)", recv_wb, NULL, 0, RE_NEED_FD },
+    { "auto",     "청크/수신버퍼/lowat 탐색 후 최선 설정으로 고정", recv_auto, NULL, 0, 0 },
+};
+const int recv_engine_count = sizeof(recv_engines) / sizeof(recv_engines[0]);
+
+const recv_engine_t* find_engine(const char* name) {
+    for (int i = 0; i < recv_engine_count; i++)
+        if (strcmp(recv_engines[i].name, name) == 0) return &recv_engines[i];
+    return NULL;
+}
@@ -0,0 +1,85 @@
+// 수신 엔진 인터페이스: 소켓에서 size 바이트를 받아 파일에 저장하는 방법들
+// (client_core 의 -e 로 선택, 네 클라이언트가 같이 씀)
+// 사용자 버퍼로 받는 엔진(read/recv/readv/busypoll)은 fill 도 제공해, 파일 대신 메모리로 받는
+// 클라이언트(staticclient, client 에코)도 같은 수신 코드를 쓴다.
+#ifndef RECV_ENGINE_H
+#define RECV_ENGINE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define BLOCK_SIZE 4096  // 블록 단위로 데이터 수신
+
+// 사용자 버퍼 엔진이 한 번에 요청하는 양
+#define WAITALL_CHUNK (256 * 1024)             // recv 엔진: 이만큼 다 찰 때까지 대기
+#define READV_SEG     (64 * 1024)              // readv 엔진: 버퍼 하나
+#define READV_NSEG    16                       //   readv 한 번에 넘기는 버퍼 수
+#define BUSY_CHUNK    (64 * 1024)              // busypoll 엔진
+
+// 엔진 한 번 실행의 결과
+typedef struct {
+    long long bytes;   // 실제 수신 바이트
+    long      calls;   // 수신 루프가 호출한 read/fwrite/splice/io_uring_enter 횟수
+    int       sum;     // 호출 전 1 이면 받은 데이터의 CRC32C 를 수신과 같은 패스에서 계산
+                       // (데이터가 사용자 공간을 거치지 않는 엔진은 0 으로 되돌린다)
+    uint32_t  crc;     // 지금까지 받은 데이터의 CRC32C
+    double    sum_sec; // CRC 계산에 쓴 시간(초)
+    int       sock_set;// 엔진이 이 수신의 소켓 설정을 마쳤음 (busypoll 의 SO_BUSY_POLL: 0 으로 시작)
+} recv_stat_t;
+
+// 엔진이 출력(싱크)에 요구하는 것
+#define RE_NEED_FD 1   // fileno(fp) 로 직접 쓴다 (splice/uring/mmap): 메모리 싱크 불가
+
+typedef struct {
+    const char* name;  // -e 옵션 이름
+    const char* desc;  // 사용법 출력용 설명
+    // sock에서 size 바이트를 받아 fp에 기록. 실패해도 받은 만큼은 st에 남긴다.
+    void (*run)(int sock, FILE* fp, long long size, recv_stat_t* st);
+    // buf 에 최대 len 바이트를 받는다 (EINTR 은 안에서 다시 시도). 받은 양, EOF 면 0, 오류 -1.
+    // 호출한 시스템 콜 수는 st->calls 에 더한다. 사용자 버퍼를 거치지 않는 엔진은 NULL
+    ssize_t (*fill)(int sock, void* buf, size_t len, recv_stat_t* st);
+    size_t chunk;      // run 이 fill 한 번에 요청하는 양 (fill 을 쓰는 쪽도 이 크기 버퍼면 같은 조건)
+    int flags;         // RE_*
+} recv_engine_t;
+
+extern const recv_engine_t recv_engines[];
+extern const int           recv_engine_count;
+
+// 이름으로 엔진 찾기 (없으면 NULL)
+const recv_engine_t* find_engine(const char* name);
+
+// 방금 받은 buf[0..n) 를 st->crc 에 이어서 계산 (st->sum 이 0 이면 아무것도 안 함)
+void recv_sum(recv_stat_t* st, const void* buf, size_t n);
+
+// 받은 n 바이트를 st->bytes 에 더한다. 진행 표시 스레드가 동시에 읽으므로 원자적으로 저장
+// (쓰는 스레드는 수신 스레드 하나뿐이라 읽고-더하고-저장해도 됨)
+static inline void recv_add(recv_stat_t* st, long long n) {
+    __atomic_store_n(&st->bytes, st->bytes + n, __ATOMIC_RELAXED);
+}
+
+// 사용자 버퍼 엔진 (recv_buf.c): fill 과, fill 로 받아 fwrite 하는 run
+ssize_t fill_read(int sock, void* buf, size_t len, recv_stat_t* st);
+ssize_t fill_recv(int sock, void* buf, size_t len, recv_stat_t* st);
+ssize_t fill_readv(int sock, void* buf, size_t len, recv_stat_t* st);
+ssize_t fill_busypoll(int sock, void* buf, size_t len, recv_stat_t* st);
+void recv_read(int sock, FILE* fp, long long size, recv_stat_t* st);
+void recv_waitall(int sock, FILE* fp, long long size, recv_stat_t* st);
+void recv_readv(int sock, FILE* fp, long long size, recv_stat_t* st);
+void recv_busypoll(int sock, FILE* fp, long long size, recv_stat_t* st);
+
+// io_uring 엔진 (recv_uring.c)
+void recv_uring(int sock, FILE* fp, long long size, recv_stat_t* st);
+
+// 청크/SO_RCVBUF/SO_RCVLOWAT 자동 조정 엔진 (recv_auto.c)
+void recv_auto(int sock, FILE* fp, long long size, recv_stat_t* st);
+// sock 에 대해 기억한 탐색 결과를 버린다 (새 연결이 같은 fd 번호를 받았을 때)
+void recv_auto_forget(int sock);
+
+// fallocate + mmap 한 출력 파일로 바로 수신하는 엔진 (recv_mmap.c)
+void recv_mmap(int sock, FILE* fp, long long size, recv_stat_t* st);
+
+// 버퍼 풀 + SPSC 링으로 수신과 디스크 쓰기를 나누는 write-behind 엔진 (recv_wb.c)
+void recv_wb(int sock, FILE* fp, long long size, recv_stat_t* st);
+
+#endif
@@ -0,0 +1,114 @@
+// mmap 수신 엔진: 출력 파일을 전체 크기로 미리 할당(fallocate)하고 mmap 한 뒤,
+// 소켓에서 매핑의 현재 오프셋으로 바로 read 한다.
+// stdio 버퍼 복사와, 쓸 때마다 파일이 늘어나며 생기는 메타데이터 갱신이 없다.
+//
+// env  :  RECV_MMAP_SYNC=none|async|sync    (기본 none)  RECV_MMAP_WINDOW 마다 msync
+//         RECV_MMAP_ADVISE=none|seq|dontneed (기본 seq)
+//             seq      : MADV_SEQUENTIAL (앞에서부터 한 번만 씀)
+//             dontneed : 윈도가 끝날 때마다 MADV_DONTNEED 로 매핑에서 내려 RSS를 일정하게 유지
+//                        (더러운 페이지는 페이지 캐시에 남아 정상적으로 디스크에 기록됨)
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "recv_engine.h"
+
+#define MMAP_CHUNK  (1024 * 1024)        // read 한 번에 요청하는 양
+#define MMAP_WINDOW (8 * 1024 * 1024)    // msync / dontneed 단위
+
+enum { SYNC_NONE, SYNC_ASYNC, SYNC_SYNC };
+enum { ADV_NONE, ADV_SEQ, ADV_DONTNEED };
+
+static int env_choice(const char* name, const char* const* opts, int n, int def) {
+    const char* v = getenv(name);
+    if (!v || !*v) return def;
+    for (int i = 0; i < n; i++)
+        if (strcmp(v, opts[i]) == 0) return i;
+    fprintf(stderr, "%s=%s 무시 (기본값 %s 사용)\n", name, v, opts[def]);
+    return def;
+}
+
+// 윈도 [from, to) 를 다 채웠을 때: 설정에 따라 msync / MADV_DONTNEED
+static void window_done(char* map, long long from, long long to, int sync, int adv, recv_stat_t* st) {
+    if (to <= from) return;
+    // msync/madvise 는 페이지 경계에서 시작해야 함 (from 은 윈도 단위라 항상 정렬됨)
+    if (sync != SYNC_NONE) {
+        msync(map + from, (size_t)(to - from), sync == SYNC_SYNC ? MS_SYNC : MS_ASYNC);
+        st->calls++;
+    }
+    if (adv == ADV_DONTNEED) {
+        madvise(map + from, (size_t)(to - from), MADV_DONTNEED);
+        st->calls++;
+    }
+}
+
+void recv_mmap(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    static const char* const sync_opts[] = { "none", "async", "sync" };
+    static const char* const adv_opts[]  = { "none", "seq", "dontneed" };
+    int sync = env_choice("RECV_MMAP_SYNC",   sync_opts, 3, SYNC_NONE);
+    int adv  = env_choice("RECV_MMAP_ADVISE", adv_opts,  3, ADV_SEQ);
+
+    fflush(fp);
+    if (size <= 0) return;
+
+    // 공유 쓰기 매핑은 읽기/쓰기로 열린 FD가 필요한데, fopen("wb")는 쓰기 전용이므로 다시 연다
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fileno(fp));
+    int out = open(path, O_RDWR);
+    if (out < 0) {
+        perror("출력 파일 다시 열기 실패 (read 엔진으로 대체)");
+        find_engine("read")->run(sock, fp, size, st);
+        return;
+    }
+
+    // 전체 크기를 미리 확보. fallocate 를 지원하지 않는 파일시스템이면 크기만 맞추지만 (빈 파일),
+    // 공간 부족(ENOSPC/EDQUOT) 같은 다른 실패에 빈 파일로 넘어가면 매핑에 쓰다 SIGBUS 로 죽으므로
+    // 그때는 read 엔진이 쓰기 오류로 알리게 한다
+    int rc = fallocate(out, 0, 0, size);
+    if (rc < 0 && (errno == EOPNOTSUPP || errno == ENOSYS)) rc = ftruncate(out, size);
+    if (rc < 0) {
+        perror("fallocate/ftruncate 실패 (read 엔진으로 대체)");
+        close(out);
+        find_engine("read")->run(sock, fp, size, st);
+        return;
+    }
+    char* map = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, out, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap 실패 (read 엔진으로 대체)");
+        ftruncate(out, 0);
+        close(out);
+        find_engine("read")->run(sock, fp, size, st);
+        return;
+    }
+    if (adv == ADV_SEQ) madvise(map, (size_t)size, MADV_SEQUENTIAL);
+
+    long long win_start = 0;
+    while (st->bytes < size) {
+        size_t want = MMAP_CHUNK;
+        if (size - st->bytes < (long long)want) want = (size_t)(size - st->bytes);
+        ssize_t n = read(sock, map + st->bytes, want);   // 커널 → 페이지 캐시, 복사 1번
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        recv_sum(st, map + st->bytes, (size_t)n);
+        recv_add(st, n);
+        st->calls++;
+        if (st->bytes - win_start >= MMAP_WINDOW) {
+            long long end = st->bytes & ~((long long)MMAP_WINDOW - 1);
+            window_done(map, win_start, end, sync, adv, st);
+            win_start = end;
+        }
+    }
+    window_done(map, win_start, st->bytes, sync, adv, st);
+    munmap(map, (size_t)size);
+
+    // 중간에 끊겼으면 미리 잡아 둔 나머지 공간을 잘라 실제 받은 크기로 맞춘다
+    if (st->bytes < size) ftruncate(out, st->bytes);
+    close(out);
+    fseeko(fp, st->bytes, SEEK_SET);
+}
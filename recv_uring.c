@@ -0,0 +1,249 @@
+// io_uring 수신 엔진 (liburing 없이 syscall 직접 사용)
+//
+// 등록 버퍼(IORING_REGISTER_BUFFERS) URING_NBUF개를 돌려 쓰며
+//   소켓 → 버퍼 : IORING_OP_READ_FIXED
+//   버퍼 → 파일 : IORING_OP_WRITE_FIXED (수신 순서대로 정한 오프셋에 기록)
+// 소켓 수신은 한 번에 하나만 걸고, 받은 버퍼의 파일 쓰기는 여러 개를 동시에 걸어 두어
+// 스레드 없이 소켓 비우기와 디스크 쓰기를 겹친다.
+// 같은 소켓에 수신을 여러 개 걸면 (io-wq 로 넘어가거나 -EAGAIN 뒤 재시도되면) 순서가 바뀌어
+// 완료될 수 있으므로, 수신이 하나뿐이어야 완료 순서 = 스트림 순서로 파일 오프셋을 매길 수 있다.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#undef BLOCK_SIZE                  // linux/fs.h 의 BLOCK_SIZE(1024)와 이름이 겹침
+
+#include "recv_engine.h"
+
+#define URING_NBUF  8               // 등록 버퍼 수 = 수신 1 + 동시에 걸 수 있는 쓰기 수
+#define URING_BUFSZ (256 * 1024)    // 버퍼 하나 크기
+
+// ===== 최소한의 링 래퍼 =====
+typedef struct {
+    int       fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void*     sq_ptr;  size_t sq_sz;
+    void*     cq_ptr;  size_t cq_sz;
+    size_t    sqe_sz;
+    unsigned  local_tail;   // 아직 커널에 공개하지 않은 SQ tail
+    unsigned  to_submit;
+} ring_t;
+
+static int ring_init(ring_t* r, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0) return -1;
+
+    r->sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        if (r->cq_sz > r->sq_sz) r->sq_sz = r->cq_sz;
+        r->cq_sz = r->sq_sz;
+    }
+    r->sq_ptr = mmap(NULL, r->sq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     r->fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED) goto fail;
+    r->cq_ptr = single ? r->sq_ptr
+                       : mmap(NULL, r->cq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              r->fd, IORING_OFF_CQ_RING);
+    if (r->cq_ptr == MAP_FAILED) goto fail;
+    r->sqe_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqe_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) goto fail;
+
+    char* sq = r->sq_ptr;
+    char* cq = r->cq_ptr;
+    r->sq_head  = (unsigned*)(sq + p.sq_off.head);
+    r->sq_tail  = (unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask  = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->cq_head  = (unsigned*)(cq + p.cq_off.head);
+    r->cq_tail  = (unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask  = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes     = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    r->local_tail = *r->sq_tail;
+    return 0;
+fail:
+    close(r->fd);
+    return -1;
+}
+
+static void ring_exit(ring_t* r) {
+    munmap(r->sqes, r->sqe_sz);
+    if (r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_sz);
+    munmap(r->sq_ptr, r->sq_sz);
+    close(r->fd);
+}
+
+// 빈 SQE 하나 (ring_enter 에서 한꺼번에 공개)
+static struct io_uring_sqe* ring_sqe(ring_t* r) {
+    unsigned idx = r->local_tail & *r->sq_mask;
+    struct io_uring_sqe* sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[idx] = idx;
+    r->local_tail++;
+    r->to_submit++;
+    return sqe;
+}
+
+// 쌓인 SQE 제출 + 완료 하나 이상 대기 (시스템 콜 1회)
+static int ring_enter(ring_t* r) {
+    __atomic_store_n(r->sq_tail, r->local_tail, __ATOMIC_RELEASE);
+    int ret;
+    do {
+        ret = (int)syscall(__NR_io_uring_enter, r->fd, r->to_submit, 1,
+                           IORING_ENTER_GETEVENTS, NULL, 0);
+    } while (ret < 0 && errno == EINTR);
+    if (ret >= 0) r->to_submit -= (unsigned)ret;
+    return ret;
+}
+
+// ===== 버퍼 상태 =====
+enum { B_IDLE, B_READING, B_WRITING };
+
+typedef struct {
+    int    state;
+    size_t len;      // 수신 요청 길이 / 수신된 길이
+    size_t done;     // 파일에 기록된 길이
+    off_t  off;      // 파일 오프셋
+} ubuf_t;
+
+#define UD(idx, is_write) (((uint64_t)(idx) << 1) | (uint64_t)(is_write))
+
+static void prep_fixed(ring_t* r, int op, int fd, char* addr, size_t len, off_t off, int idx, int is_write) {
+    struct io_uring_sqe* sqe = ring_sqe(r);
+    sqe->opcode    = (uint8_t)op;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t)(uintptr_t)addr;
+    sqe->len       = (uint32_t)len;
+    sqe->off       = (uint64_t)off;
+    sqe->buf_index = (uint16_t)idx;
+    sqe->user_data = UD(idx, is_write);
+}
+
+void recv_uring(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    ring_t r;
+    if (ring_init(&r, URING_NBUF * 2) < 0) {
+        perror("io_uring_setup 실패 (read 엔진으로 대체)");
+        find_engine("read")->run(sock, fp, size, st);
+        return;
+    }
+
+    // 버퍼를 한 덩어리로 할당해 등록 (페이지 고정 → 매번 매핑하는 비용 없음)
+    char* mem = mmap(NULL, (size_t)URING_NBUF * URING_BUFSZ, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    struct iovec iov[URING_NBUF];
+    for (int i = 0; i < URING_NBUF; i++) {
+        iov[i].iov_base = mem + (size_t)i * URING_BUFSZ;
+        iov[i].iov_len  = URING_BUFSZ;
+    }
+    if (mem == MAP_FAILED ||
+        syscall(__NR_io_uring_register, r.fd, IORING_REGISTER_BUFFERS, iov, URING_NBUF) < 0) {
+        perror("io_uring 버퍼 등록 실패 (read 엔진으로 대체)");
+        if (mem != MAP_FAILED) munmap(mem, (size_t)URING_NBUF * URING_BUFSZ);
+        ring_exit(&r);
+        find_engine("read")->run(sock, fp, size, st);
+        return;
+    }
+
+    fflush(fp);
+    int out = fileno(fp);
+    ubuf_t b[URING_NBUF];
+    memset(b, 0, sizeof(b));
+
+    long long reserved = 0;   // 수신 완료 + 수신 대기 중인 바이트 (size를 넘지 않게)
+    off_t     write_off = 0;  // 다음 수신 데이터가 들어갈 파일 오프셋
+    int       inflight = 0;
+    int       reading = 0;    // 걸려 있는 수신 (0 또는 1)
+    int       stop = 0;       // EOF/오류: 새 수신은 걸지 않고 남은 작업만 마무리
+
+    while (1) {
+        // 수신이 걸려 있지 않으면 쉬고 있는 버퍼 하나로 건다
+        for (int i = 0; i < URING_NBUF && !reading && !stop && reserved < size; i++) {
+            if (b[i].state != B_IDLE) continue;
+            size_t want = URING_BUFSZ;
+            if (size - reserved < (long long)want) want = (size_t)(size - reserved);
+            b[i].state = B_READING;
+            b[i].len   = want;
+            reserved  += (long long)want;
+            prep_fixed(&r, IORING_OP_READ_FIXED, sock, iov[i].iov_base, want, 0, i, 0);
+            inflight++;
+            reading = 1;
+        }
+        if (inflight == 0) break;
+
+        if (ring_enter(&r) < 0) {
+            perror("io_uring_enter 실패");
+            break;
+        }
+        st->calls++;
+
+        // 완료된 것들 처리
+        unsigned head = *r.cq_head;
+        unsigned tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe* cqe = &r.cqes[head & *r.cq_mask];
+            int i = (int)(cqe->user_data >> 1);
+            int is_write = (int)(cqe->user_data & 1);
+            int res = cqe->res;
+            inflight--;
+
+            if (!is_write) {
+                reading = 0;
+                reserved -= (long long)b[i].len;
+                if (res <= 0) {           // EOF 또는 오류
+                    if (res < 0) fprintf(stderr, "io_uring 수신 실패: %s\n", strerror(-res));
+                    b[i].state = B_IDLE;
+                    stop = 1;
+                    continue;
+                }
+                reserved   += res;
+                recv_add(st, res);
+                recv_sum(st, iov[i].iov_base, (size_t)res);   // 수신은 하나씩이므로 스트림 순서
+                b[i].state  = B_WRITING;
+                b[i].len    = (size_t)res;
+                b[i].done   = 0;
+                b[i].off    = write_off;
+                write_off  += res;
+                prep_fixed(&r, IORING_OP_WRITE_FIXED, out, iov[i].iov_base, b[i].len, b[i].off, i, 1);
+                inflight++;
+            } else {
+                if (res < 0) {
+                    fprintf(stderr, "io_uring 파일 쓰기 실패: %s\n", strerror(-res));
+                    b[i].state = B_IDLE;
+                    stop = 1;
+                    continue;
+                }
+                b[i].done += (size_t)res;
+                if (b[i].done < b[i].len) {   // 일부만 써졌으면 나머지 다시 제출
+                    prep_fixed(&r, IORING_OP_WRITE_FIXED, out, (char*)iov[i].iov_base + b[i].done,
+                               b[i].len - b[i].done, b[i].off + (off_t)b[i].done, i, 1);
+                    inflight++;
+                } else {
+                    b[i].state = B_IDLE;
+                }
+            }
+        }
+        __atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    // 이후 stdio 가 이어서 쓸 경우를 위해 파일 위치를 맞춰 둔다
+    fseeko(fp, write_off, SEEK_SET);
+    munmap(mem, (size_t)URING_NBUF * URING_BUFSZ);
+    ring_exit(&r);
+}
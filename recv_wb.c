@@ -0,0 +1,260 @@
+// write-behind 수신 엔진: 소켓 수신과 디스크 쓰기를 다른 스레드로 나눈다.
+// 한 스레드에서 read → fwrite 를 번갈아 하면 디스크가 잠깐 멈출 때 수신도 멈추고,
+// 그동안 TCP 윈도가 닫혀 보내는 쪽까지 느려진다.
+//
+//   수신 스레드(호출한 스레드) : 빈 버퍼를 꺼내 소켓에서 가득 채움 → full 링에 넣음
+//   쓰기 스레드                : full 링에서 꺼내 파일에 pwrite → free 링으로 돌려줌
+// 버퍼는 고정 개수(정렬된 풀)를 돌려 쓰고, 두 링은 각각 생산자/소비자가 하나뿐이라 잠금 없이
+// head/tail 원자 변수만으로 주고받는다 (SPSC). 링이 비면 잠깐 돌다가 짧게 자며 기다리고, 그 횟수와
+// 시간을 센다: 수신 쪽이 기다리면 버퍼가 모두 쓰기 대기 중 = 디스크가 병목,
+//             쓰기 쪽이 기다리면 쓸 데이터가 없음      = 네트워크가 병목.
+//
+// env  :  RECV_WB_BUFS=16        버퍼 개수 (2 ~ 255)
+//         RECV_WB_BUF_KB=1024    버퍼 하나 크기 (4KB 단위로 올림)
+//         RECV_WB_DIRECT=1       O_DIRECT 로 쓰기 (페이지 캐시를 거치지 않음. 마지막 조각처럼
+//                                4KB 배수가 아닌 쓰기는 그때만 O_DIRECT 를 끄고 씀)
+//         RECV_WB_FILL=read      버퍼를 채우는 수신 엔진 (read|recv|readv|busypoll)
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "recv_engine.h"
+
+#define WB_ALIGN    4096       // O_DIRECT 정렬 단위 (버퍼 주소, 길이, 파일 오프셋)
+#define WB_RING     256        // 링 칸 수 (2의 거듭제곱). 버퍼는 최대 WB_RING - 1 개: 끝 표시 자리
+#define WB_DONE     0xffffffffu // full 링에 넣는 끝 표시
+#define WB_SPIN     256        // 링이 비었을 때 자기 전에 돌아 보는 횟수
+#define WB_NAP_NS   20000      // 그다음엔 20us 씩 자며 기다림
+
+// 생산자 하나, 소비자 하나. head 는 소비자만, tail 은 생산자만 쓴다 (서로 다른 캐시 라인)
+// 가득 찼는지는 확인하지 않는다: 버퍼 수 + 끝 표시 하나가 WB_RING 을 넘지 않게 개수를 제한한다
+typedef struct {
+    uint32_t head __attribute__((aligned(64)));
+    uint32_t tail __attribute__((aligned(64)));
+    uint32_t slot[WB_RING] __attribute__((aligned(64)));
+} ring_t;
+
+// 링이 비어 기다린 횟수와 시간
+typedef struct {
+    long   count;
+    double sec;
+} stall_t;
+
+typedef struct {
+    ring_t    full, free;        // full: 수신 → 쓰기, free: 쓰기 → 수신
+    char*     mem;               // 버퍼 풀 (WB_ALIGN 정렬)
+    size_t    bufsz;
+    int       nbuf;
+    size_t    len[WB_RING];      // full 로 넘긴 버퍼의 데이터 길이
+    int       fd;                // 쓰기 FD
+    int       direct;            // fd 가 O_DIRECT 로 열려 있음
+    off_t     off0;              // 첫 쓰기 위치
+    long long written;
+    long      calls;             // 쓰기 스레드의 시스템 콜 수
+    int       err;               // 쓰기 실패 (수신 스레드도 멈춘다)
+    stall_t   wstall;            // 쓰기 스레드가 데이터를 기다림
+    double    done_sec;           // 디스크 쓰기 완료 시각
+} wb_t;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void ring_push(ring_t* r, uint32_t v) {
+    uint32_t t = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+    r->slot[t & (WB_RING - 1)] = v;
+    __atomic_store_n(&r->tail, t + 1, __ATOMIC_RELEASE);
+}
+
+static int ring_pop(ring_t* r, uint32_t* v) {
+    uint32_t h = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+    if (h == __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) return -1;
+    *v = r->slot[h & (WB_RING - 1)];
+    __atomic_store_n(&r->head, h + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// 링에 들어 있는 칸 수 (어느 스레드에서 봐도 근사값)
+static uint32_t ring_count(ring_t* r) {
+    return __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+// 꺼낼 때까지 기다린다. 비어 있었으면 대기 한 번으로 세고 기다린 시간을 더한다
+static uint32_t ring_wait(ring_t* r, stall_t* s) {
+    uint32_t v;
+    if (ring_pop(r, &v) == 0) return v;
+    double t0 = now_s();
+    for (long spin = 0; ring_pop(r, &v) < 0; spin++) {
+        if (spin < WB_SPIN) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+            continue;
+        }
+        struct timespec ts = { 0, WB_NAP_NS };
+        nanosleep(&ts, NULL);
+    }
+    s->count++;
+    s->sec += now_s() - t0;
+    return v;
+}
+
+// buf[0..len) 를 off 에 끝까지 쓴다. O_DIRECT 는 길이가 정렬 단위 배수일 때만 쓸 수 있으므로
+// 마지막 조각처럼 어긋난 쓰기는 그 전에 O_DIRECT 를 끈다
+static int write_at(wb_t* w, const char* buf, size_t len, off_t off) {
+    if (w->direct && (len % WB_ALIGN) != 0) {
+        int fl = fcntl(w->fd, F_GETFL);
+        fcntl(w->fd, F_SETFL, fl & ~O_DIRECT);
+        w->direct = 0;
+        w->calls += 2;
+    }
+    while (len > 0) {
+        ssize_t n = pwrite(w->fd, buf, len, off);
+        w->calls++;
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        buf += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+
+static void* writer_main(void* arg) {
+    wb_t* w = arg;
+    while (1) {
+        uint32_t i = ring_wait(&w->full, &w->wstall);
+        if (i == WB_DONE) break;
+        if (!__atomic_load_n(&w->err, __ATOMIC_RELAXED)) {   // 실패한 뒤에는 버퍼만 돌려준다
+            if (write_at(w, w->mem + (size_t)i * w->bufsz, w->len[i], w->off0 + w->written) < 0) {
+                perror("write-behind 쓰기 실패");
+                __atomic_store_n(&w->err, 1, __ATOMIC_RELAXED);
+            } else {
+                w->written += (long long)w->len[i];
+            }
+        }
+        ring_push(&w->free, i);
+    }
+    w->done_sec = now_s();
+    return NULL;
+}
+
+static int env_int(const char* name, int def, int lo, int hi) {
+    const char* v = getenv(name);
+    if (!v || !*v) return def;
+    int x = atoi(v);
+    if (x < lo || x > hi) {
+        fprintf(stderr, "%s=%s 무시 (%d ~ %d, 기본값 %d 사용)\n", name, v, lo, hi, def);
+        return def;
+    }
+    return x;
+}
+
+void recv_wb(int sock, FILE* fp, long long size, recv_stat_t* st) {
+    const char* fname = getenv("RECV_WB_FILL");
+    const recv_engine_t* fe = find_engine(fname && *fname ? fname : "read");
+    if (!fe || !fe->fill) {
+        fprintf(stderr, "RECV_WB_FILL=%s 무시 (사용자 버퍼 엔진이 아님, read 사용)\n", fname);
+        fe = find_engine("read");
+    }
+
+    static wb_t w;   // 링이 커서 스택에 두지 않는다 (엔진은 한 번에 하나만 실행)
+    memset(&w, 0, sizeof(w));
+    w.nbuf  = env_int("RECV_WB_BUFS", 16, 2, WB_RING - 1);
+    w.bufsz = ((size_t)env_int("RECV_WB_BUF_KB", 1024, 4, 1 << 20) * 1024 + WB_ALIGN - 1) & ~(size_t)(WB_ALIGN - 1);
+    if (posix_memalign((void**)&w.mem, WB_ALIGN, w.bufsz * (size_t)w.nbuf) != 0) {
+        perror("write-behind 버퍼 할당 실패 (read 엔진으로 대체)");
+        find_engine("read")->run(sock, fp, size, st);
+        return;
+    }
+
+    fflush(fp);   // stdio 버퍼에 남은 것이 있으면 먼저 내보내고, 그 끝부터 pwrite 로 이어 쓴다
+    w.fd   = fileno(fp);
+    w.off0 = lseek(w.fd, 0, SEEK_END);
+    if (w.off0 < 0) w.off0 = 0;
+    const char* d = getenv("RECV_WB_DIRECT");
+    if (d && *d == '1') {
+        // O_DIRECT 는 파일 오프셋도 정렬돼야 한다 (이어 받기로 중간부터 쓰면 못 씀)
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fileno(fp));
+        int dfd = (w.off0 % WB_ALIGN) == 0 ? open(path, O_WRONLY | O_DIRECT) : -1;
+        if (dfd < 0) {
+            fprintf(stderr, "[wb] O_DIRECT 사용 불가 (%s), 페이지 캐시로 씀\n",
+                    (w.off0 % WB_ALIGN) ? "쓰기 시작 위치가 4KB 정렬 아님" : strerror(errno));
+        } else {
+            w.fd     = dfd;
+            w.direct = 1;
+        }
+    }
+    int was_direct = w.direct;
+    for (int i = 0; i < w.nbuf; i++) ring_push(&w.free, (uint32_t)i);
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, writer_main, &w) != 0) {
+        perror("쓰기 스레드 생성 실패 (read 엔진으로 대체)");
+        if (w.direct) close(w.fd);
+        free(w.mem);
+        find_engine("read")->run(sock, fp, size, st);
+        return;
+    }
+
+    // 수신: 빈 버퍼를 꺼내 가득(또는 남은 양만큼) 채워 넘긴다
+    stall_t rstall = { 0, 0.0 };
+    double occ_sum = 0;
+    uint32_t occ_max = 0;
+    long pushes = 0;
+    double t0 = now_s();
+    int eof = 0;
+    while (st->bytes < size && !eof && !__atomic_load_n(&w.err, __ATOMIC_RELAXED)) {
+        uint32_t i = ring_wait(&w.free, &rstall);
+        char* buf = w.mem + (size_t)i * w.bufsz;
+        size_t cap = w.bufsz, len = 0;
+        if (size - st->bytes < (long long)cap) cap = (size_t)(size - st->bytes);
+        while (len < cap) {
+            ssize_t n = fe->fill(sock, buf + len, cap - len, st);
+            if (n <= 0) {
+                eof = 1;
+                break;
+            }
+            recv_sum(st, buf + len, (size_t)n);
+            len += (size_t)n;
+            recv_add(st, n);
+        }
+        if (len == 0) break;   // 이 버퍼는 돌려줄 필요 없음 (곧 끝남)
+        w.len[i] = len;
+        ring_push(&w.full, i);
+        uint32_t occ = ring_count(&w.full);
+        occ_sum += occ;
+        if (occ > occ_max) occ_max = occ;
+        pushes++;
+    }
+    double net_done = now_s();
+    ring_push(&w.full, WB_DONE);
+    pthread_join(tid, NULL);
+
+    st->calls += w.calls;
+    if (w.direct || was_direct) close(w.fd);
+    free(w.mem);
+    fseeko(fp, w.off0 + w.written, SEEK_SET);
+
+    // 보고: 어느 쪽이 더 오래 기다렸는지가 병목의 반대편
+    fprintf(stderr, "[wb] 버퍼 %d x %zuKB, O_DIRECT %s, 채우기 %s\n",
+            w.nbuf, w.bufsz / 1024, was_direct ? "켬" : "끔", fe->name);
+    fprintf(stderr, "[wb] 쓰기 대기 중 버퍼 평균 %.1f / 최대 %u (총 %d)\n",
+            pushes ? occ_sum / pushes : 0.0, occ_max, w.nbuf);
+    fprintf(stderr, "[wb] 수신 스레드 대기 %ld회 %.3f초 (빈 버퍼 없음 = 디스크 대기), "
+                    "쓰기 스레드 대기 %ld회 %.3f초 (쓸 데이터 없음 = 네트워크 대기)\n",
+            rstall.count, rstall.sec, w.wstall.count, w.wstall.sec);
+    fprintf(stderr, "[wb] 수신 완료 %.3f초, 디스크 완료 %.3f초 → 병목: %s\n",
+            net_done - t0, w.done_sec - t0,
+            rstall.sec > w.wstall.sec ? "디스크" : "네트워크");
+}
@@ -0,0 +1,418 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "replay.h"
+#include "hdr_hist.h"
+#include "phase.h"
+
+#define QUEUE_CAP     65536                    // 대기 요청 상한: open loop 라 도착을 늦출 수 없으므로 넘치면 버리고 센다
+#define HIST_MAX_NS   (3600LL * 1000000000LL)  // 기록 가능한 최대 지연 1시간
+#define START_LEAD_NS 1000000ULL               // 단계 시작 → 첫 도착 기준 시각 여유 (1ms)
+
+typedef struct {
+    uint64_t  at_ns;     // 도착 시각 (file: 시작 기준 상대값, 큐: CLOCK_MONOTONIC 절대값)
+    long long bytes;
+} job_t;
+
+// 도착 큐: 디스패처(main) 하나가 넣고 연결 스레드들이 꺼낸다
+static struct {
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;        // 일감이 생김 / 닫힘
+    pthread_cond_t  idle;      // pending 이 0 이 됨
+    job_t           q[QUEUE_CAP];
+    size_t          head, len;
+    long            pending;   // 큐에 있는 것 + 처리 중인 것
+    size_t          max_len;   // 이번 단계 최대 대기 수
+    long            dropped;   // 큐가 넘쳐 버린 요청
+    int             closed;
+} Q = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+typedef struct {
+    pthread_t            tid;
+    int                  conn;
+    int*                 sock;
+    const recv_engine_t* eng;
+    int                (*reconnect)(int conn);
+    hdr_hist_t           queue, service, total;   // ns
+    long                 done, failed, reconnects;
+    long long            bytes;
+    uint64_t             last_ns;                 // 이번 단계 마지막 완료 시각
+} worker_t;
+
+static long long g_req;   // -T 기록용 요청 번호
+
+// ===== 해석 =====
+
+// "64K" "1M" "2G", 단위 없으면 MB. 실패 -1
+static long long parse_size(const char* s) {
+    char* end;
+    double v = strtod(s, &end);
+    double unit = 1024.0 * 1024.0;
+    if (*end == 'K' || *end == 'k')      { unit = 1024.0; end++; }
+    else if (*end == 'M' || *end == 'm') { end++; }
+    else if (*end == 'G' || *end == 'g') { unit = 1024.0 * 1024.0 * 1024.0; end++; }
+    if (end == s || (*end && *end != ':' && *end != ',') || v <= 0) return -1;
+    long long b = (long long)(v * unit);
+    return b > 0 ? b : -1;
+}
+
+int replay_parse(replay_cfg_t* c, const char* arrivals, const char* sizes, double duration) {
+    memset(c, 0, sizeof(*c));
+    c->duration = duration;
+    const char* list;
+    if (strncmp(arrivals, "poisson:", 8) == 0)    { c->kind = REPLAY_POISSON; list = arrivals + 8; }
+    else if (strncmp(arrivals, "fixed:", 6) == 0) { c->kind = REPLAY_FIXED;   list = arrivals + 6; }
+    else if (strncmp(arrivals, "file:", 5) == 0) {
+        c->kind = REPLAY_FILE;
+        snprintf(c->path, sizeof(c->path), "%s", arrivals + 5);
+        return 0;
+    } else {
+        fprintf(stderr, "알 수 없는 도착 형식: %s (poisson:도착률,... | fixed:도착률,... | file:경로)\n", arrivals);
+        return -1;
+    }
+    for (const char* p = list; *p && c->nrates < REPLAY_MAX_RATES; ) {
+        char* end;
+        double r = strtod(p, &end);
+        if (end == p || r <= 0 || (*end && *end != ',')) {
+            fprintf(stderr, "잘못된 도착률: %s\n", list);
+            return -1;
+        }
+        c->rates[c->nrates++] = r;
+        p = *end ? end + 1 : end;
+    }
+    if (c->nrates == 0 || duration <= 0) {
+        fprintf(stderr, "도착률과 단계 시간(-D)이 필요함\n");
+        return -1;
+    }
+
+    if (!sizes) sizes = "1";
+    for (const char* p = sizes; *p && c->nsizes < REPLAY_MAX_SIZES; ) {
+        long long b = parse_size(p);
+        const char* q = p + strcspn(p, ":,");
+        double w = 1.0;
+        if (*q == ':') {
+            char* end;
+            w = strtod(q + 1, &end);
+            q = end;
+        }
+        if (b < 0 || w <= 0 || (*q && *q != ',')) {
+            fprintf(stderr, "잘못된 크기 분포: %s (예: 64K:0.8,4M:0.2)\n", sizes);
+            return -1;
+        }
+        c->sizes[c->nsizes]   = b;
+        c->weights[c->nsizes] = w;
+        c->nsizes++;
+        p = *q ? q + 1 : q;
+    }
+    return c->nsizes > 0 ? 0 : -1;
+}
+
+static int cmp_job(const void* a, const void* b) {
+    const job_t* x = a;
+    const job_t* y = b;
+    return (x->at_ns > y->at_ns) - (x->at_ns < y->at_ns);
+}
+
+// 작업 파일 읽기: "<시각(초)> <크기>" 줄들, 시각 순으로 정렬해 돌려준다 (실패 시 NULL)
+static job_t* load_file(const char* path, long* n) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror("작업 파일 열기 실패");
+        return NULL;
+    }
+    long cap = 1024, cnt = 0, lineno = 0;
+    job_t* v = malloc((size_t)cap * sizeof(job_t));
+    char line[256];
+    while (v && fgets(line, sizeof(line), f)) {
+        lineno++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        double t;
+        char sz[64];
+        int k = sscanf(line, "%lf %63s", &t, sz);
+        if (k <= 0) continue;   // 빈 줄 / 주석
+        long long b = k == 2 ? parse_size(sz) : -1;
+        if (t < 0 || b < 0) {
+            fprintf(stderr, "%s:%ld: \"<시각(초)> <크기>\" 형식이 아님\n", path, lineno);
+            free(v);
+            v = NULL;
+            break;
+        }
+        if (cnt == cap) {
+            job_t* nv = realloc(v, (size_t)(cap *= 2) * sizeof(job_t));
+            if (!nv) { free(v); v = NULL; break; }
+            v = nv;
+        }
+        v[cnt].at_ns = (uint64_t)(t * 1e9);
+        v[cnt].bytes = b;
+        cnt++;
+    }
+    fclose(f);
+    if (v && cnt == 0) {
+        fprintf(stderr, "%s: 요청이 없음\n", path);
+        free(v);
+        v = NULL;
+    }
+    if (v) qsort(v, (size_t)cnt, sizeof(job_t), cmp_job);
+    *n = cnt;
+    return v;
+}
+
+// ===== 큐 =====
+
+static void push(uint64_t at, long long bytes) {
+    pthread_mutex_lock(&Q.mu);
+    if (Q.len == QUEUE_CAP) {
+        Q.dropped++;
+    } else {
+        Q.q[(Q.head + Q.len) % QUEUE_CAP] = (job_t){ at, bytes };
+        Q.len++;
+        Q.pending++;
+        if (Q.len > Q.max_len) Q.max_len = Q.len;
+        pthread_cond_signal(&Q.cv);
+    }
+    pthread_mutex_unlock(&Q.mu);
+}
+
+// 일감 하나 꺼내기 (닫히고 비었으면 -1)
+static int pop(job_t* j) {
+    pthread_mutex_lock(&Q.mu);
+    while (Q.len == 0 && !Q.closed) pthread_cond_wait(&Q.cv, &Q.mu);
+    int ok = Q.len > 0;
+    if (ok) {
+        *j = Q.q[Q.head];
+        Q.head = (Q.head + 1) % QUEUE_CAP;
+        Q.len--;
+    }
+    pthread_mutex_unlock(&Q.mu);
+    return ok ? 0 : -1;
+}
+
+static void finish(void) {
+    pthread_mutex_lock(&Q.mu);
+    if (--Q.pending == 0) pthread_cond_signal(&Q.idle);
+    pthread_mutex_unlock(&Q.mu);
+}
+
+// ===== 연결 스레드 =====
+
+// 요청 하나: 응답을 끝까지 받으면 0 (끊기면 소켓을 닫고 -1)
+static int serve(worker_t* w, const job_t* j, char* buf, uint64_t t0) {
+    if (*w->sock < 0) {
+        if ((*w->sock = w->reconnect(w->conn)) < 0) return -1;
+        w->reconnects++;
+    }
+    int sock = *w->sock;
+    char req[64];
+    int len = snprintf(req, sizeof(req), "R 0 %lld\n", j->bytes);   // 구간 요청: MB 단위가 아닌 크기도 가능
+    phase_t ph;
+    memset(&ph, 0, sizeof(ph));
+    long long got = 0;
+    recv_stat_t st = { 0, 0 };
+    if (write(sock, req, (size_t)len) == len) {
+        ph.sent_ns = phase_now();
+        while (got < j->bytes) {
+            size_t want = w->eng->chunk;
+            if (j->bytes - got < (long long)want) want = (size_t)(j->bytes - got);
+            ssize_t n = w->eng->fill(sock, buf, want, &st);
+            if (n <= 0) break;
+            if (got == 0) ph.first_ns = phase_now();
+            got += n;
+        }
+    }
+    ph.last_ns = phase_now();
+    ph.bytes   = got;
+    if (got < j->bytes) {
+        close(sock);
+        *w->sock = -1;
+        return -1;
+    }
+    hdr_record(&w->queue,   (int64_t)(t0 > j->at_ns ? t0 - j->at_ns : 0));
+    hdr_record(&w->service, (int64_t)(ph.last_ns - t0));
+    hdr_record(&w->total,   (int64_t)(ph.last_ns - j->at_ns));
+    w->bytes  += got;
+    w->last_ns = ph.last_ns;
+    phase_emit(&ph, "client_stream", w->eng->name, w->conn,
+               __atomic_fetch_add(&g_req, 1, __ATOMIC_RELAXED), j->bytes >> 20, sock);
+    return 0;
+}
+
+static void* worker_main(void* arg) {
+    worker_t* w = arg;
+    char* buf = malloc(w->eng->chunk);
+    job_t j;
+    while (pop(&j) == 0) {
+        uint64_t t0 = phase_now();   // 꺼낸 시각 = 서비스 시작
+        if (buf && serve(w, &j, buf, t0) == 0) w->done++;
+        else                                   w->failed++;
+        finish();
+    }
+    free(buf);
+    return NULL;
+}
+
+// ===== 단계 =====
+
+static void sleep_until(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+}
+
+static long long pick_size(const replay_cfg_t* c) {
+    double sum = 0;
+    for (int i = 0; i < c->nsizes; i++) sum += c->weights[i];
+    double u = drand48() * sum;
+    for (int i = 0; i < c->nsizes; i++)
+        if ((u -= c->weights[i]) < 0) return c->sizes[i];
+    return c->sizes[c->nsizes - 1];
+}
+
+static double ms(int64_t ns) {
+    return ns / 1e6;
+}
+
+// 한 단계 재생 후 한 줄 출력. rate: 목표 도착률 (file 이면 0), 대기 p99 가 서비스 p99 를 넘으면 1
+static int run_step(const replay_cfg_t* c, double rate, const job_t* list, long nlist,
+                    worker_t* ws, int nconn) {
+    for (int i = 0; i < nconn; i++) {
+        hdr_reset(&ws[i].queue);
+        hdr_reset(&ws[i].service);
+        hdr_reset(&ws[i].total);
+        ws[i].done = ws[i].failed = 0;
+        ws[i].bytes = 0;
+        ws[i].last_ns = 0;
+    }
+    pthread_mutex_lock(&Q.mu);
+    Q.max_len = 0;
+    Q.dropped = 0;
+    pthread_mutex_unlock(&Q.mu);
+
+    // 예정 시각에 맞춰 넣기만 한다 (응답을 기다리지 않음). 늦게 깨도 대기 시간은 예정 시각부터 잰다
+    uint64_t t0 = phase_now() + START_LEAD_NS;
+    long arrivals = 0;
+    double span;   // 도착 구간 길이(초)
+    if (list) {
+        for (long i = 0; i < nlist; i++, arrivals++) {
+            sleep_until(t0 + list[i].at_ns);
+            push(t0 + list[i].at_ns, list[i].bytes);
+        }
+        span = list[nlist - 1].at_ns / 1e9;
+        if (span <= 0) span = 1e-9;
+    } else {
+        double off = 0, end = c->duration * 1e9;
+        while (1) {
+            off += c->kind == REPLAY_POISSON ? -log(1.0 - drand48()) / rate * 1e9 : 1e9 / rate;
+            if (off >= end) break;
+            sleep_until(t0 + (uint64_t)off);
+            push(t0 + (uint64_t)off, pick_size(c));
+            arrivals++;
+        }
+        span = c->duration;
+    }
+
+    // 남은 요청을 다 처리할 때까지 기다린 뒤 스레드별 기록을 모은다
+    pthread_mutex_lock(&Q.mu);
+    while (Q.pending > 0) pthread_cond_wait(&Q.idle, &Q.mu);
+    size_t max_len = Q.max_len;
+    long   dropped = Q.dropped;
+    pthread_mutex_unlock(&Q.mu);
+
+    hdr_hist_t hq = ws[0].queue, hs = ws[0].service, ht = ws[0].total;   // 0번에 모은다
+    long done = 0, failed = 0;
+    long long bytes = 0;
+    uint64_t last = t0;
+    for (int i = 0; i < nconn; i++) {
+        if (i > 0) {
+            hdr_add(&hq, &ws[i].queue);
+            hdr_add(&hs, &ws[i].service);
+            hdr_add(&ht, &ws[i].total);
+        }
+        done   += ws[i].done;
+        failed += ws[i].failed;
+        bytes  += ws[i].bytes;
+        if (ws[i].last_ns > last) last = ws[i].last_ns;
+    }
+    double el = (last - t0) / 1e9;
+    if (el <= 0) el = 1e-9;
+    double offered = arrivals / span;
+    double util = offered * hdr_mean(&hs) / 1e9 / nconn;   // 연결 풀 이용률 추정 (리틀의 법칙)
+    int knee = hq.total > 0 && hdr_percentile(&hq, 99) > hdr_percentile(&hs, 99);
+
+    char target[16];
+    if (list) snprintf(target, sizeof(target), "파일");
+    else      snprintf(target, sizeof(target), "%.0f", rate);
+    printf(" %8s %9.1f %9.1f %9.2f %6.2f | %8.3f %8.3f | %8.3f %8.3f | %8.3f %8.3f %9.3f | %6zu %5ld%s\n",
+           target, offered, done / el, bytes / (1024.0 * 1024.0) / el, util,
+           ms(hdr_percentile(&hq, 50)), ms(hdr_percentile(&hq, 99)),
+           ms(hdr_percentile(&hs, 50)), ms(hdr_percentile(&hs, 99)),
+           ms(hdr_percentile(&ht, 50)), ms(hdr_percentile(&ht, 99)), ms(hdr_percentile(&ht, 99.9)),
+           max_len, failed + dropped, knee ? "  <- 대기 > 서비스" : "");
+    fflush(stdout);
+    return knee;
+}
+
+void replay_run(const replay_cfg_t* c, int* socks, int nconn, const recv_engine_t* eng,
+                int (*reconnect)(int conn)) {
+    job_t* list = NULL;
+    long nlist = 0;
+    if (c->kind == REPLAY_FILE && !(list = load_file(c->path, &nlist))) return;
+
+    signal(SIGPIPE, SIG_IGN);   // 서버가 끊은 연결에 요청을 써도 죽지 않고 다시 연결
+    srand48((long)getpid());
+    Q.closed = 0;
+
+    worker_t ws[nconn];
+    memset(ws, 0, sizeof(ws));   // 중간에 실패해도 아래 정리에서 hdr_free 가 모든 칸에 안전하도록 전부 먼저 비움
+    int started = 0;
+    for (int i = 0; i < nconn; i++) {
+        ws[i].conn      = i;
+        ws[i].sock      = &socks[i];
+        ws[i].eng       = eng;
+        ws[i].reconnect = reconnect;
+        if (hdr_init(&ws[i].queue, HIST_MAX_NS, 3) < 0 || hdr_init(&ws[i].service, HIST_MAX_NS, 3) < 0 ||
+            hdr_init(&ws[i].total, HIST_MAX_NS, 3) < 0 ||
+            pthread_create(&ws[i].tid, NULL, worker_main, &ws[i]) != 0) {
+            fprintf(stderr, "재생 스레드 준비 실패\n");
+            break;
+        }
+        started++;
+    }
+
+    if (started == nconn) {
+        printf("재생: 연결 %d개, 엔진 %s, %s\n", nconn, eng->name,
+               list ? "작업 파일" : c->kind == REPLAY_POISSON ? "포아송 도착" : "일정 간격 도착");
+        printf(" %8s %9s %9s %9s %6s | %17s | %17s | %27s | %6s %5s\n",
+               "목표/s", "도착/s", "완료/s", "MB/s", "이용률",
+               "대기 p50/p99 ms", "서비스 p50/p99 ms", "전체 p50/p99/p99.9 ms", "최대큐", "실패");
+        double knee_rate = 0;
+        int steps = list ? 1 : c->nrates;
+        for (int s = 0; s < steps; s++) {
+            double rate = list ? 0 : c->rates[s];
+            if (run_step(c, rate, list, nlist, ws, nconn) && knee_rate == 0 && !list) knee_rate = rate;
+        }
+        if (!list && knee_rate > 0)
+            printf("무릎: 초당 %.0f 건부터 대기 p99 가 서비스 p99 보다 큼 (이 부근부터 꼬리 지연은 연결 %d개 풀의 대기가 좌우)\n",
+                   knee_rate, nconn);
+        else if (!list)
+            printf("무릎: 모든 단계에서 대기 p99 < 서비스 p99 (더 높은 도착률로 다시 재 볼 것)\n");
+    }
+
+    pthread_mutex_lock(&Q.mu);
+    Q.closed = 1;
+    pthread_cond_broadcast(&Q.cv);
+    pthread_mutex_unlock(&Q.mu);
+    for (int i = 0; i < started; i++) pthread_join(ws[i].tid, NULL);
+    for (int i = 0; i < nconn; i++) {
+        hdr_free(&ws[i].queue);
+        hdr_free(&ws[i].service);
+        hdr_free(&ws[i].total);
+    }
+    free(list);
+}
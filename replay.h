@@ -0,0 +1,42 @@
+// 작업 재생(open-loop): 사람이 크기를 입력하는 대신, 도착 시각이 정해진 요청들을 연결 풀에 흘려 보낸다.
+// 요청은 응답을 기다리지 않고 예정 시각에 큐에 들어가고(open loop), 쉬는 연결이 꺼내 처리한다.
+// 그래서 요청마다
+//   대기 = 꺼내 보낸 시각 - 예정 도착 시각   (연결이 모자라 줄 선 시간)
+//   서비스 = 마지막 바이트 - 보낸 시각        (네트워크 + 서버)
+// 을 따로 잰다. 도착률을 단계별로 올리면 대기가 서비스보다 커지는 지점(지연의 무릎)이 보인다.
+// (client_stream -W 가 씀)
+//
+// 도착 (-W)  poisson:100,200,400   초당 100 → 200 → 400 건, 지수 분포 간격 (단계마다 -D 초)
+//            fixed:50              초당 50 건 일정 간격
+//            file:작업.txt         한 줄에 "<시각(초)> <크기>" (시각은 시작 기준, # 뒤는 주석)
+// 크기 (-S)  10 | 64K | 1M:0.7,16M:0.3   (단위 없으면 MB, ":비율" 로 가중치. file 이면 파일의 크기)
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "recv_engine.h"
+
+#define REPLAY_MAX_RATES 32
+#define REPLAY_MAX_SIZES 16
+
+typedef struct {
+    int       kind;                         // REPLAY_*
+    double    rates[REPLAY_MAX_RATES];      // 초당 요청 수 (단계별)
+    int       nrates;
+    double    duration;                     // 단계당 초
+    long long sizes[REPLAY_MAX_SIZES];      // 바이트
+    double    weights[REPLAY_MAX_SIZES];
+    int       nsizes;
+    char      path[256];                    // file
+} replay_cfg_t;
+
+enum { REPLAY_POISSON, REPLAY_FIXED, REPLAY_FILE };
+
+// -W / -S 해석. 성공 0, 실패 -1 (메시지 출력)
+int replay_parse(replay_cfg_t* c, const char* arrivals, const char* sizes, double duration);
+
+// socks[0..nconn) 연결마다 스레드 하나로 재생하고 단계별 표를 출력한다.
+// 끊긴 연결은 reconnect(conn) 으로 다시 연다 (실패 시 -1). 받은 데이터는 버린다
+void replay_run(const replay_cfg_t* c, int* socks, int nconn, const recv_engine_t* eng,
+                int (*reconnect)(int conn));
+
+#endif
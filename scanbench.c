@@ -0,0 +1,121 @@
+// build:  make scanbench
+// run  :  ./scanbench                          (256MB, 기본 패턴, 64KB 단위 feed)
+//         ./scanbench -s 1024 -c 4096          (1GB, 4KB read 를 흉내)
+//         ./scanbench -p 'Z,ABC,\x00\xff'      (myread 와 같은 패턴 문법)
+//
+// pscan 스캐너 처리량 측정: 서버와 같은 A~Z 데이터를 -c 바이트씩 pscan_feed 에 넣으면서
+// 구현(memchr / sse2 / avx2)별 GB/s 를 잰다. read 경계에 걸치도록 패턴을 일부러 심어 두고,
+// 모든 구현과 "한 번에 통째로 넣은 결과"의 일치 수/위치 합이 같은지도 확인한다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "pscan.h"
+
+typedef struct {
+    uint64_t count;
+    uint64_t off_sum;   // 위치 합 (구현 간 비교용)
+} result_t;
+
+static void on_match(void* arg, int pat, uint64_t off) {
+    result_t* r = arg;
+    r->count++;
+    r->off_sum += off * 31 + (uint64_t)pat;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static result_t run(const pscan_t* ps, const uint8_t* data, size_t size, size_t chunk) {
+    result_t r = { 0, 0 };
+    pscan_stream_t st;
+    memset(&st, 0, sizeof(st));
+    for (size_t off = 0; off < size; off += chunk) {
+        size_t n = size - off < chunk ? size - off : chunk;
+        pscan_feed(ps, &st, data + off, n, on_match, &r);
+    }
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    size_t size_mb = 256, chunk = 65536;
+    int repeats = 3;
+    const char* spec = "Z,QWERTY,HELLOWORLD,\\x00\\xff";
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:p:r:")) != -1) {
+        switch (opt) {
+        case 's': size_mb = (size_t)atol(optarg); break;
+        case 'c': chunk   = (size_t)atol(optarg); break;
+        case 'p': spec    = optarg; break;
+        case 'r': repeats = atoi(optarg); break;
+        default:
+            fprintf(stderr, "사용법: %s [-s MB] [-c feed단위] [-p 패턴] [-r 반복]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (size_mb == 0 || chunk == 0 || repeats < 1) {
+        fprintf(stderr, "잘못된 인자\n");
+        return 1;
+    }
+
+    pscan_t ps;
+    if (pscan_init(&ps, spec) < 0) return 1;
+
+    size_t size = size_mb * 1024 * 1024;
+    uint8_t* data = malloc(size);
+    if (!data) {
+        perror("malloc 실패");
+        return 1;
+    }
+    // 서버(server.c)와 같은 xorshift A~Z 데이터
+    unsigned int x = 2463534242u;
+    for (size_t i = 0; i < size; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        data[i] = (uint8_t)('A' + x % 26);
+    }
+    // 1MB 마다 각 패턴을 feed 경계에 걸치도록 심는다
+    size_t planted = 0;
+    for (size_t base = chunk; base + PSCAN_MAX_LEN < size; base += 1024 * 1024) {
+        for (int k = 0; k < ps.n; k++) {
+            size_t at = base - (size_t)(ps.len[k] / 2) + (size_t)k * 4 * chunk;
+            if (at + (size_t)ps.len[k] >= size) continue;
+            memcpy(data + at, ps.pat[k], (size_t)ps.len[k]);
+            planted++;
+        }
+    }
+
+    printf("데이터 %zu MB, feed 단위 %zu 바이트, 패턴 %d개 (최장 %d), 경계에 심은 패턴 %zu개\n",
+           size_mb, chunk, ps.n, ps.maxlen, planted);
+
+    // 기준: 통째로 한 번에 (경계 처리 없음)
+    pscan_set_impl(&ps, "memchr");
+    result_t ref = run(&ps, data, size, size);
+
+    static const char* impls[] = { "memchr", "sse2", "avx2" };
+    printf("%-8s %10s %12s %8s\n", "구현", "GB/s", "일치", "검증");
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        if (pscan_set_impl(&ps, impls[i]) < 0) {
+            printf("%-8s %10s\n", impls[i], "지원 안 함");
+            continue;
+        }
+        double best = 1e30;
+        result_t r = { 0, 0 };
+        for (int rep = 0; rep < repeats; rep++) {
+            double t0 = now_s();
+            r = run(&ps, data, size, chunk);
+            double el = now_s() - t0;
+            if (el < best) best = el;
+        }
+        int ok = r.count == ref.count && r.off_sum == ref.off_sum;
+        printf("%-8s %10.2f %12llu %8s\n", impls[i], size / best / 1e9,
+               (unsigned long long)r.count, ok ? "ok" : "불일치");
+    }
+    free(data);
+    return 0;
+}
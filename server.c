@@ -0,0 +1,230 @@
+// build:  make server
+// run  :  ./server                   (127.0.0.1:8888, 다운로드 프로토콜)
+//         ./server -m echo -p 8889   (client.c 용 에코 프로토콜)
+//         ./server -b 0.0.0.0        (모든 인터페이스에서 대기)
+//         ./server -x 30             (연결마다 30MB 를 보내면 끊음: 재개(client_stream -R) 테스트용)
+//
+// 클라이언트들과 같은 프로토콜을 쓰는 로컬 기준 서버 (벤치마크용)
+//   stream : "<MB>" 또는 "<MB>\n" (파이프라인) → MB × 1MB 원시 데이터, "exit" → 연결 종료
+//            "<MB> crc" → 데이터 뒤에 CRC32C 트레일러 "CRC32C xxxxxxxx\n" (16바이트)를 붙임
+//            "R <시작> <길이>[ crc]" → 무한히 반복되는 패턴 스트림의 [시작, 시작+길이) 바이트 (이어 받기용)
+//   echo   : 받은 바이트를 그대로 돌려줌, "exit" → 연결 종료
+// 연결마다 스레드 하나. 응답 데이터는 고정 시드로 만든 1MB 패턴의 반복이라
+// 같은 크기의 응답은 항상 같은 바이트열이다 (구간을 나눠 받아 이어 붙여도 동일).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "crc32c.h"
+
+#define PATTERN_SIZE (1024 * 1024)
+#define REQ_BUF      1024
+
+enum { M_STREAM, M_ECHO };
+
+static int  g_mode  = M_STREAM;
+static int  g_quiet = 0;
+static long long g_drop = 0;           // -x: 연결당 이만큼 보내면 끊음 (0 = 끊지 않음)
+static __thread long long t_sent;      // 이 연결에서 지금까지 보낸 응답 바이트
+static char g_pattern[PATTERN_SIZE];   // 응답 데이터 (1MB 반복)
+
+// 고정 시드 xorshift 로 패턴 생성 (staticclient 의 "앞부분" 출력이 깨지지 않게 A~Z 만 사용)
+static void init_pattern(void) {
+    unsigned int x = 2463534242u;
+    for (int i = 0; i < PATTERN_SIZE; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        g_pattern[i] = (char)('A' + x % 26);
+    }
+}
+
+// 부분 전송을 처리하며 len 바이트를 모두 보낸다
+static int send_all(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        buf += n; len -= (size_t)n;
+    }
+    return 0;
+}
+
+// 스트림 위치 [off, off+len) 전송 (위치 p 의 바이트 = g_pattern[p % 1MB]).
+// with_crc 면 보낸 데이터의 CRC32C 를 같이 계산해 트레일러로 붙인다
+static int send_range(int fd, long long off, long long len, int with_crc) {
+    uint32_t crc = 0;
+    while (len > 0) {
+        size_t at = (size_t)(off % PATTERN_SIZE);
+        size_t n  = PATTERN_SIZE - at;
+        if ((long long)n > len) n = (size_t)len;
+        if (g_drop > 0 && t_sent + (long long)n >= g_drop) {   // -x: 한도까지만 보내고 끊는다
+            send_all(fd, g_pattern + at, (size_t)(g_drop - t_sent));
+            if (!g_quiet) printf("서버: fd=%d %lld 바이트 보내고 연결 끊음 (-x)\n", fd, g_drop);
+            return -1;
+        }
+        if (with_crc) crc = crc32c_update(crc, g_pattern + at, n);
+        if (send_all(fd, g_pattern + at, n) < 0) return -1;
+        t_sent += (long long)n;
+        off    += (long long)n;
+        len    -= (long long)n;
+    }
+    if (!with_crc) return 0;
+    char trailer[CRC32C_TRAILER_LEN + 1];
+    snprintf(trailer, sizeof(trailer), "CRC32C %08x\n", crc);
+    return send_all(fd, trailer, CRC32C_TRAILER_LEN);
+}
+
+// 요청 한 줄 처리: 0 계속, -1 연결 종료
+static int handle_request(int fd, char* req) {
+    req[strcspn(req, "\r\n")] = '\0';
+    if (req[0] == '\0') return 0;
+    if (strncmp(req, "exit", 4) == 0) return -1;
+    long long off, len;
+    if (req[0] == 'R') {
+        int end = 0;
+        if (sscanf(req, "R %lld %lld%n", &off, &len, &end) != 2 || off < 0 || len <= 0) {
+            if (!g_quiet) printf("서버: fd=%d 잘못된 구간 요청 \"%s\"\n", fd, req);
+            return 0;
+        }
+        int with_crc = strcmp(req + end, " crc") == 0;
+        if (!g_quiet) printf("서버: fd=%d 구간 %lld+%lld 전송%s\n", fd, off, len,
+                             with_crc ? " (CRC32C 트레일러)" : "");
+        return send_range(fd, off, len, with_crc);
+    }
+    long long mb = atoll(req);
+    const char* opt = strchr(req, ' ');
+    int with_crc = opt && strcmp(opt + 1, "crc") == 0;
+    if (mb <= 0) {
+        if (!g_quiet) printf("서버: fd=%d 잘못된 요청 \"%s\"\n", fd, req);
+        return 0;
+    }
+    if (!g_quiet) printf("서버: fd=%d %lld MB 전송%s\n", fd, mb, with_crc ? " (CRC32C 트레일러)" : "");
+    return send_range(fd, 0, mb * PATTERN_SIZE, with_crc);
+}
+
+static void serve_stream(int fd) {
+    char buf[REQ_BUF];
+    size_t used = 0;
+    while (1) {
+        ssize_t n = recv(fd, buf + used, sizeof(buf) - 1 - used, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        int saw_nl = memchr(buf + used, '\n', (size_t)n) != NULL;
+        used += (size_t)n;
+        buf[used] = '\0';
+
+        // 개행 없이 온 요청 (기존 클라이언트: "10" 만 보내고 응답을 기다림)
+        if (!saw_nl) {
+            if (handle_request(fd, buf) < 0) return;
+            used = 0;
+            continue;
+        }
+
+        // 개행으로 끝난 요청들을 차례로 처리 (파이프라인). 끝에 남은 조각은 다음 수신과 합친다
+        char* line = buf;
+        char* nl;
+        while ((nl = memchr(line, '\n', used - (size_t)(line - buf))) != NULL) {
+            *nl = '\0';
+            if (handle_request(fd, line) < 0) return;
+            line = nl + 1;
+        }
+        used -= (size_t)(line - buf);
+        memmove(buf, line, used);
+        if (used == sizeof(buf) - 1) used = 0;   // 너무 긴 줄은 버린다
+    }
+}
+
+static void serve_echo(int fd) {
+    char buf[4096];
+    while (1) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        if (n >= 4 && strncmp(buf, "exit", 4) == 0) return;
+        if (send_all(fd, buf, (size_t)n) < 0) return;
+    }
+}
+
+static void* conn_main(void* arg) {
+    int fd = (int)(long)arg;
+    t_sent = 0;
+    if (g_mode == M_ECHO) {
+        int one = 1;   // 작은 왕복 메시지: Nagle 끄기
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        serve_echo(fd);
+    } else {
+        serve_stream(fd);
+    }
+    if (!g_quiet) printf("서버: fd=%d 연결 종료\n", fd);
+    close(fd);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    char bind_ip[64] = "127.0.0.1";
+    int  port = 8888;
+    int  opt;
+    while ((opt = getopt(argc, argv, "b:p:m:qx:")) != -1) {
+        switch (opt) {
+        case 'b': snprintf(bind_ip, sizeof(bind_ip), "%s", optarg); break;
+        case 'p': port = atoi(optarg); break;
+        case 'm':
+            if (strcmp(optarg, "echo") == 0)        g_mode = M_ECHO;
+            else if (strcmp(optarg, "stream") == 0) g_mode = M_STREAM;
+            else goto usage;
+            break;
+        case 'q': g_quiet = 1; break;
+        case 'x': g_drop = (long long)(atof(optarg) * 1024 * 1024); break;
+        default:
+usage:
+            fprintf(stderr, "사용법: %s [-b 주소] [-p 포트] [-m stream|echo] [-q] [-x 끊을MB]\n", argv[0]);
+            return 1;
+        }
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGPIPE, SIG_IGN);
+    init_pattern();
+
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons((uint16_t)port);
+    if (inet_pton(AF_INET, bind_ip, &addr.sin_addr) != 1) {
+        fprintf(stderr, "잘못된 주소: %s\n", bind_ip);
+        return 1;
+    }
+    if (bind(lfd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(lfd, 4096) < 0) {
+        perror("bind/listen 실패");
+        return 1;
+    }
+    printf("서버: %s:%d 대기 중 (%s)\n", bind_ip, port, g_mode == M_ECHO ? "echo" : "stream");
+
+    while (1) {
+        int cfd = accept(lfd, NULL, NULL);
+        if (cfd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno == EMFILE || errno == ENFILE) { usleep(1000); continue; }
+            perror("accept 실패");
+            break;
+        }
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, conn_main, (void*)(long)cfd) != 0) {
+            close(cfd);
+            continue;
+        }
+        pthread_detach(tid);
+    }
+    close(lfd);
+    return 0;
+}
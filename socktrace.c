@@ -1,24 +1,64 @@
-// build:  gcc -shared -fPIC -O2 -pthread -ldl -o libsocktrace.so socktrace.c
+// build:  make libsocktrace.so
+//         (gcc -shared -fPIC -O2 -pthread -ldl -o libsocktrace.so socktrace.c)
 // run  :  LD_PRELOAD=./libsocktrace.so ./server   (또는 ./client)
 // env  :  SOCKTRACE_PREFIX="[trace] "  // (선택) 로그 앞에 붙일 접두사
+//         SOCKTRACE_BIN=/tmp/st           // (선택) 텍스트 대신 바이너리로 /tmp/st.<pid>.<n> 에 기록
+//         SOCKTRACE_BIN_MB=64             //        파일 하나의 크기 (가득 차면 다음 파일로 회전)
+//         SOCKTRACE_BIN_FILES=4           //        회전할 파일 수 (오래된 것부터 덮어씀)
+//         SOCKTRACE_FD=5,7-9              // (선택) 이 FD 만 기록
+//         SOCKTRACE_PEER=10.0.0.2:8888    //        이 상대만 (주소 | :포트 | 주소:포트 | [v6]:포트)
+//         SOCKTRACE_DIR=in                //        in = 받는 호출만, out = 보내는 호출만
+//         SOCKTRACE_MIN_BYTES=4096        //        이보다 적게 주고받은 데이터 이벤트 제외
+//         SOCKTRACE_SAMPLE=100            //        스레드마다 데이터 이벤트 100개 중 1개만
+//         SOCKTRACE_SAMPLE_US=1000        //        스레드마다 1ms 에 데이터 이벤트 1개만
+//         SOCKTRACE_BUDGET=10000          //        프로세스 전체 초당 이벤트 상한 (넘으면 버리고 셈)
+//         SOCKTRACE_REPORT_SEC=10         //        자체 오버헤드 보고 주기 (0 = 끝날 때 한 번만)
+// 해석 :  ./socktrace_dec [-f text|csv|conn] /tmp/st.*
+//
+// 후킹: connect, accept/accept4, read/write, send/recv, readv/writev, sendmsg/recvmsg,
+//       sendmmsg/recvmmsg (바이트는 메시지 합), sendfile, splice (소켓 쪽만), close, dup/dup2/dup3.
+//       close 하면 FD 메타를 비우고, dup 한 FD 는 원래 FD 의 끝점 ID를 물려받는다.
+//       MSG_PEEK 수신은 데이터를 소비하지 않으므로 기록하지 않는다 (실제로 읽을 때 한 번만 셈).
+// 구조: 후킹 함수는 고정 크기 이벤트 레코드를 자기 스레드의 링 버퍼에 넣기만 한다 (락 없음).
+//       포맷과 stderr 출력은 백그라운드 drainer 스레드가 모아서 한다.
+//       로컬/피어 주소는 connect/accept 때(또는 처음 본 소켓이면 첫 호출 때) 한 번만 조회해
+//       끝점 ID를 붙여 캐시하고, 이벤트에는 ID만 남긴다 (형식은 socktrace_fmt.h).
+// 주의: 출력 순서는 스레드 안에서만 보장된다. 스레드 간 순서는 t= 값으로 정렬해서 볼 것.
+//       링이 가득 차면 이벤트를 버리고 개수만 센다 (후킹 호출이 출력 때문에 막히지 않게).
+// 거르기: 필터(fd/peer/방향/최소 바이트) → 샘플링 → 초당 예산 순. connect/accept 는 연결 정보라
+//       fd/peer 필터와 예산만 적용한다. 거른 수와 버린 수는 모두 세어 주기 보고에 나온다.
+// 자체 비용: 후킹 안 처리 시간을 OVH_EVERY 번에 한 번 재고 drainer 의 CPU 시간과 더해,
+//       프로세스 CPU 중 트레이서 몫을 보고한다 (이 값이 크면 추적이 측정 대상을 바꾼 것).
 
 #define _GNU_SOURCE
 #include <dlfcn.h>       // dlsym, RTLD_NEXT
 #include <sys/socket.h>  // socket API, getsockopt, SOL_SOCKET, SO_TYPE
 #include <sys/types.h>
-#include <sys/time.h>
+#include <sys/mman.h>    // 링 버퍼 할당 (malloc 재진입 회피)
+#include <sys/syscall.h> // SYS_gettid
+#include <sys/uio.h>     // readv, writev
+#include <sys/sendfile.h>
+#include <fcntl.h>       // open (바이너리 추적 파일)
 #include <netinet/in.h>  // sockaddr_in
 #include <arpa/inet.h>   // inet_ntop
-#include <pthread.h>     // pthread_mutex_* (멀티스레드 보호)
+#include <pthread.h>     // drainer 스레드, 스레드 종료 감지
 #include <errno.h>
 #include <stdarg.h>
 #include <string.h>
+#include <stdlib.h>      // getenv
 #include <stdint.h>
 #include <unistd.h>      // read, write
 #include <stdio.h>
 #include <time.h>        // clock_gettime
 
-#define FD_SETSIZE 1024  // 데모용 FD 메타 테이블 크기(간단하게)
+#include "socktrace_fmt.h"
+
+#define MAX_FD       1024          // 데모용 FD 메타 테이블 크기(간단하게)
+#define MAX_EP       65536         // 끝점 테이블 (ID % MAX_EP 칸에 저장, 2의 거듭제곱)
+#define RING_SIZE    4096          // 스레드당 이벤트 수 (2의 거듭제곱)
+#define DRAIN_NS     1000000       // drainer 주기 (1ms)
+#define OUT_BUF      (64 * 1024)   // drainer 출력 버퍼
+#define OVH_EVERY    64            // 후킹 처리 시간을 재는 간격 (스레드마다, 2의 거듭제곱)
 
 
 // ---------- 원래 libc 심볼 포인터들 (후킹에서 원함수 호출용) ----------
@@ -28,24 +68,115 @@ static ssize_t (*real_send)(int, const void*, size_t, int);
 static ssize_t (*real_recv)(int, void*, size_t, int);
 static int     (*real_connect)(int, const struct sockaddr*, socklen_t);
 static int     (*real_accept)(int, struct sockaddr*, socklen_t*);
+static int     (*real_accept4)(int, struct sockaddr*, socklen_t*, int);
+static ssize_t (*real_readv)(int, const struct iovec*, int);
+static ssize_t (*real_writev)(int, const struct iovec*, int);
+static ssize_t (*real_recvmsg)(int, struct msghdr*, int);
+static ssize_t (*real_sendmsg)(int, const struct msghdr*, int);
+static int     (*real_recvmmsg)(int, struct mmsghdr*, unsigned int, int, struct timespec*);
+static int     (*real_sendmmsg)(int, struct mmsghdr*, unsigned int, int);
+static ssize_t (*real_sendfile)(int, int, off_t*, size_t);
+static ssize_t (*real_sendfile64)(int, int, off64_t*, size_t);
+static ssize_t (*real_splice)(int, loff_t*, int, loff_t*, size_t, unsigned int);
+static int     (*real_close)(int);
+static int     (*real_dup)(int);
+static int     (*real_dup2)(int, int);
+static int     (*real_dup3)(int, int, int);
+
+// ---------- FD별 메타데이터(끝점 ID) ----------
+// state 는 ep 를 채운 뒤 release 로 바꾸고, 읽는 쪽은 acquire 로 확인한다
+enum { FD_UNKNOWN, FD_NOT_SOCKET, FD_SOCKET };
 
-// 전역 락: FD 메타 데이터 갱신 및 로그 출력의 경쟁상태를 막기 위함
-static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+typedef union {                         // IPv4/IPv6 둘 다 담는 최소 크기 (28바이트)
+    struct sockaddr     sa;
+    struct sockaddr_in  in;
+    struct sockaddr_in6 in6;
+} addr_t;
 
-// ---------- FD별 메타데이터(로컬/피어 주소, 패밀리 등) ----------
 typedef struct {
-    int inited;                         // 이 FD에 대해 초기화했는지
-    int is_socket;                      // 소켓 FD인지 여부(SO_TYPE으로 판별)
-    int family;                         // 주소 패밀리(AF_INET/AF_INET6)
-    struct sockaddr_storage local;      // getsockname 결과(로컬)
-    struct sockaddr_storage peer;       // getpeername 결과(상대)
-    socklen_t               local_len;
-    socklen_t               peer_len;
+    int      state;                     // FD_UNKNOWN / FD_NOT_SOCKET / FD_SOCKET
+    uint32_t ep;                        // 현재 연결의 끝점 ID
+    int      pass;                      // fd/peer 필터 통과 여부 (끝점을 잡을 때 한 번 판단)
 } fd_meta;
 
-static fd_meta M[FD_SETSIZE];           // 데모용 고정 테이블
+// 끝점 (connect/accept 때 한 번 조회한 로컬/피어 주소)
+typedef struct {
+    uint32_t id;                        // 이 칸을 마지막으로 쓴 끝점 ID
+    addr_t   local;                     // getsockname 결과(로컬)
+    addr_t   peer;                      // getpeername 결과(상대)
+} ep_slot;
+
+static fd_meta  M[MAX_FD];              // 데모용 고정 테이블
+static ep_slot  EP[MAX_EP];
+static uint32_t g_next_ep = 1;          // 0 은 "모름"
 static char g_prefix[64] = "";          // 로그 접두사
 
+// 텍스트 출력 태그 (ST_OP_* 순서)
+static const char* ev_tags[ST_OP_COUNT] = {
+    "", "[connect ok]", "[connect err]", "[accept ok]", "[send] ", "[recv] ", "[read] ", "[write]", "", "",
+    "[readv]", "[writev]", "[recvmsg]", "[sendmsg]", "[recvmmsg]", "[sendmmsg]", "[sendfile]",
+    "[splice in]", "[splice out]", "[close]", "[dup]"
+};
+
+// 링에 들어가는 이벤트 = 바이너리 파일 레코드 그대로 (tid 는 drainer 가 채움)
+typedef st_rec_t event_t;
+
+// ---------- 스레드별 링 (생산자 = 해당 스레드, 소비자 = drainer) ----------
+enum { RING_FREE, RING_USED, RING_RETIRED };
+
+// 스레드별 누적 카운터 (생산자만 올리고 drainer 는 합산만). calls = kept + 거른 수 + 버린 수
+typedef struct {
+    uint64_t calls;                     // 이벤트로 남길지 판단한 소켓 호출
+    uint64_t kept;                      // 링에 넣은 이벤트
+    uint64_t filtered;                  // fd/peer/방향/최소 바이트 필터로 제외
+    uint64_t sampled;                   // 샘플링으로 제외
+    uint64_t budget;                    // 초당 예산 초과로 버림
+    uint64_t ovh_ns;                    // 잰 호출들의 후킹 처리 시간 합
+    uint64_t ovh_n;                     //   잰 호출 수
+} st_count_t;
+
+// 생산자 한 명만 쓰는 값이라 원자 연산 없이 relaxed 저장으로 올린다
+#define BUMP(x, d) __atomic_store_n(&(x), (x) + (d), __ATOMIC_RELAXED)
+
+typedef struct ring {
+    uint64_t     head;                  // 생산자만 씀
+    st_count_t   c;                     // 생산자만 씀 (head 와 같은 캐시 라인, 56바이트)
+    uint64_t     tail;                  // drainer 만 씀 (head 와 다른 캐시 라인: false sharing 방지)
+    char         pad1[56];
+    uint64_t     dropped;               // 가득 차서 버린 이벤트 수 (drainer 가 보고 후 0으로)
+    uint64_t     nth;                   // 샘플링: 지난 기록 뒤 건너뛴 수 (생산자만)
+    uint64_t     last_t;                //         마지막으로 기록한 시각 (생산자만)
+    uint64_t     budget_seen;           // drainer 가 이미 알린 c.budget
+    int          state;                 // RING_*
+    int          tid;
+    struct ring* next;                  // 전체 링 목록 (앞에 추가만 함)
+    event_t      ev[RING_SIZE];
+} ring_t;
+
+static ring_t*       g_rings;           // 링 목록 머리
+static pthread_key_t g_key;             // 스레드 종료 시 링 반납용
+static int           g_ready;           // 생성자 완료 후에만 기록
+static int           g_drainer_on;      // drainer 실행 여부 (fork 후 자식에서 0)
+static int           g_stop;
+static pthread_t     g_drainer;
+static __thread ring_t* t_ring __attribute__((tls_model("initial-exec")));
+
+// ---------- 필터 / 샘플링 / 예산 (생성자에서 env 로 정하고 이후엔 읽기만) ----------
+static uint64_t g_fdmask[MAX_FD/64];    // SOCKTRACE_FD 에 적힌 FD
+static int      g_fd_filter;            // 0 = 모든 FD
+static int      g_peer_filter;          // SOCKTRACE_PEER 설정 여부
+static int      g_peer_family;          //   주소 (0 = 주소 무관)
+static uint8_t  g_peer_addr[16];
+static uint16_t g_peer_port;            //   포트 (0 = 포트 무관)
+static uint32_t g_opmask = ~0u;         // SOCKTRACE_DIR 로 남길 데이터 op (1 << ST_OP_*)
+static int64_t  g_min_bytes;            // SOCKTRACE_MIN_BYTES
+static uint64_t g_sample_n;             // SOCKTRACE_SAMPLE (0, 1 = 전부)
+static uint64_t g_sample_ns;            // SOCKTRACE_SAMPLE_US
+static uint64_t g_budget;               // SOCKTRACE_BUDGET (0 = 무제한)
+static uint64_t g_bud_sec, g_bud_used;  //   지금 초와 그 초에 쓴 양 (모든 스레드 공유)
+static uint64_t g_report_ns = 10000000000ULL;   // SOCKTRACE_REPORT_SEC
+static uint64_t g_clock_ns;             // now_ns 한 번 비용 (후킹이 호출 전에 재는 시각, 생성자에서 잼)
+
 // ---------- 유틸: 재귀 방지 write ----------
 static inline void safe_write(const char* s, size_t n){
     // printf는 내부에서 write를 호출 → 재귀 위험.
@@ -54,8 +185,8 @@ static inline void safe_write(const char* s, size_t n){
     (void)real_write(STDERR_FILENO, s, n);
 }
 
-// printf 스타일 포맷 로깅(접두사 + vsnprintf + safe_write)
-static void logf(const char* fmt, ...){
+// printf 스타일 포맷 로깅(접두사 + vsnprintf + safe_write) — 시작/종료 메시지용
+static void log_msg(const char* fmt, ...){
     char buf[512];
     int n = 0;
     if (g_prefix[0]) n = snprintf(buf, sizeof(buf), "%s", g_prefix);
@@ -65,63 +196,632 @@ static void logf(const char* fmt, ...){
     if (n>0) safe_write(buf, (size_t)n);
 }
 
-// MONOTONIC 시간(초) — 벽시계 변경 영향 없음
-static double now_s(void){
+// MONOTONIC 시간(ns) — 벽시계 변경 영향 없음, vDSO 라 시스템 콜 없음
+static inline uint64_t now_ns(void){
     struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
-    return ts.tv_sec + ts.tv_nsec/1e9;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-// 소켓 FD 여부 판별(SO_TYPE 조회 성공 시 소켓)
-static int is_socket_fd(int fd){
-    int t; socklen_t l=sizeof(t);
-    return getsockopt(fd, SOL_SOCKET, SO_TYPE, &t, &l) == 0;
+static inline int fd_match(int fd){
+    return !g_fd_filter || ((g_fdmask[fd >> 6] >> (fd & 63)) & 1);
 }
 
-// 로컬/피어 주소 갱신 (연결 후/수신/송신 시 최신화)
-static void refresh_endpoints(int fd){
-    if (fd<0 || fd>=FD_SETSIZE) return;
-    fd_meta* m = &M[fd];
-    if (!m->is_socket) return;
-    m->local_len = sizeof(m->local);
-    m->peer_len  = sizeof(m->peer);
-    getsockname(fd, (struct sockaddr*)&m->local, &m->local_len);
-    getpeername (fd, (struct sockaddr*)&m->peer,  &m->peer_len);
+// 상대 주소가 SOCKTRACE_PEER 와 맞는지 (IPv4 필터는 v4 매핑 IPv6 주소 ::ffff:a.b.c.d 와도 비교)
+static int peer_match(const addr_t* a){
+    if (!g_peer_filter) return 1;
+    int fam = a->sa.sa_family;
+    const uint8_t* ip;
+    uint16_t port;
+    if (fam == AF_INET){
+        ip   = (const uint8_t*)&a->in.sin_addr;
+        port = ntohs(a->in.sin_port);
+    } else if (fam == AF_INET6){
+        ip   = a->in6.sin6_addr.s6_addr;
+        port = ntohs(a->in6.sin6_port);
+        if (g_peer_family == AF_INET && IN6_IS_ADDR_V4MAPPED(&a->in6.sin6_addr)){ fam = AF_INET; ip += 12; }
+    } else {
+        return 0;
+    }
+    if (g_peer_port && port != g_peer_port) return 0;
+    if (g_peer_family && (fam != g_peer_family || memcmp(ip, g_peer_addr, fam == AF_INET ? 4 : 16) != 0))
+        return 0;
+    return 1;
+}
+
+// 주소 조회 후 새 끝점 ID를 붙이고 소켓으로 표시 (connect/accept 때, 또는 처음 보는 소켓이면 한 번)
+static void capture_endpoints(int fd){
+    uint32_t id = __atomic_fetch_add(&g_next_ep, 1, __ATOMIC_RELAXED);
+    ep_slot* e = &EP[id & (MAX_EP-1)];
+    socklen_t ll = sizeof(e->local), pl = sizeof(e->peer);
+    memset(&e->local, 0, sizeof(e->local));
+    memset(&e->peer,  0, sizeof(e->peer));
+    getsockname(fd, &e->local.sa, &ll);
+    getpeername(fd, &e->peer.sa,  &pl);
+    __atomic_store_n(&e->id, id, __ATOMIC_RELEASE);
+    M[fd].ep   = id;
+    M[fd].pass = fd_match(fd) && peer_match(&e->peer);
+    __atomic_store_n(&M[fd].state, FD_SOCKET, __ATOMIC_RELEASE);
 }
 
-// FD 메타 초기화(최초 접근 시 1회)
-static void ensure_fd(int fd){
-    if (fd<0 || fd>=FD_SETSIZE) return;
+// 끝점 ID의 주소 (칸이 이미 다른 끝점으로 재사용됐으면 NULL)
+static const ep_slot* ep_lookup(uint32_t id){
+    const ep_slot* e = &EP[id & (MAX_EP-1)];
+    return id && __atomic_load_n(&e->id, __ATOMIC_ACQUIRE) == id ? e : NULL;
+}
+
+// 소켓 FD면 메타 반환, 아니면 NULL. 판별(SO_TYPE)은 FD마다 처음 한 번만
+static inline fd_meta* socket_meta(int fd){
+    if (fd<0 || fd>=MAX_FD) return NULL;
     fd_meta* m = &M[fd];
-    if (!m->inited){
-        memset(m, 0, sizeof(*m));
-        m->inited   = 1;
-        m->is_socket= is_socket_fd(fd);
-        if (m->is_socket) {
-            m->local_len = sizeof(m->local);
-            m->peer_len  = sizeof(m->peer);
-            getsockname(fd, (struct sockaddr*)&m->local, &m->local_len);
-            getpeername (fd, (struct sockaddr*)&m->peer,  &m->peer_len);
-            if (m->local.ss_family) m->family = m->local.ss_family;
-            else if (m->peer.ss_family) m->family = m->peer.ss_family;
+    int st = __atomic_load_n(&m->state, __ATOMIC_ACQUIRE);
+    if (st == FD_UNKNOWN){
+        int t; socklen_t l=sizeof(t);
+        if (getsockopt(fd, SOL_SOCKET, SO_TYPE, &t, &l) == 0) {
+            capture_endpoints(fd);
+            st = FD_SOCKET;
+        } else {
+            __atomic_store_n(&m->state, FD_NOT_SOCKET, __ATOMIC_RELEASE);
+            st = FD_NOT_SOCKET;
         }
     }
+    return st == FD_SOCKET ? m : NULL;
 }
 
 // 주소 출력용 포맷터(IPv4/IPv6 지원)
-static void fmt_addr(char* out, size_t cap, const struct sockaddr_storage* ss){
+static void fmt_addr(char* out, size_t cap, const addr_t* a){
     out[0]='\0';
-    if (!ss || ss->ss_family==0) { snprintf(out, cap, "?"); return; }
-    if (ss->ss_family == AF_INET){
-        const struct sockaddr_in* a = (const struct sockaddr_in*)ss;
-        char ip[INET_ADDRSTRLEN]; inet_ntop(AF_INET, &a->sin_addr, ip, sizeof(ip));
-        snprintf(out, cap, "%s:%u", ip, (unsigned)ntohs(a->sin_port));
-    } else if (ss->ss_family == AF_INET6){
-        const struct sockaddr_in6* a = (const struct sockaddr_in6*)ss;
-        char ip[INET6_ADDRSTRLEN]; inet_ntop(AF_INET6, &a->sin6_addr, ip, sizeof(ip));
-        snprintf(out, cap, "[%s]:%u", ip, (unsigned)ntohs(a->sin6_port));
+    if (!a) {
+        snprintf(out, cap, "?");
+    } else if (a->sa.sa_family == AF_INET){
+        char ip[INET_ADDRSTRLEN]; inet_ntop(AF_INET, &a->in.sin_addr, ip, sizeof(ip));
+        snprintf(out, cap, "%s:%u", ip, (unsigned)ntohs(a->in.sin_port));
+    } else if (a->sa.sa_family == AF_INET6){
+        char ip[INET6_ADDRSTRLEN]; inet_ntop(AF_INET6, &a->in6.sin6_addr, ip, sizeof(ip));
+        snprintf(out, cap, "[%s]:%u", ip, (unsigned)ntohs(a->in6.sin6_port));
+    } else if (a->sa.sa_family == 0) {
+        snprintf(out, cap, "?");
     } else {
-        snprintf(out, cap, "fam=%d", ss->ss_family);
+        snprintf(out, cap, "fam=%d", a->sa.sa_family);
+    }
+}
+
+// ---------- 링 관리 ----------
+
+// 스레드 종료: 링을 RETIRED 로. drainer 가 다 비운 뒤 FREE 로 돌려 다른 스레드가 재사용
+static void ring_release(void* p){
+    t_ring = NULL;   // 이후 다른 TLS 소멸자에서 호출되면 링을 새로 잡는다
+    __atomic_store_n(&((ring_t*)p)->state, RING_RETIRED, __ATOMIC_RELEASE);
+}
+
+// 이 스레드의 링 (처음 호출 시 빈 링을 재사용하거나 새로 할당해 목록에 추가)
+static ring_t* my_ring(void){
+    if (t_ring) return t_ring;
+    ring_t* r;
+    for (r = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE); r; r = r->next){
+        int expect = RING_FREE;
+        if (__atomic_compare_exchange_n(&r->state, &expect, RING_USED, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) break;
+    }
+    if (!r){
+        r = mmap(NULL, sizeof(ring_t), PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (r == MAP_FAILED) return NULL;
+        r->state = RING_USED;
+        r->next  = __atomic_load_n(&g_rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&g_rings, &r->next, r, 1,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
     }
+    r->tid = (int)syscall(SYS_gettid);
+    t_ring = r;
+    pthread_setspecific(g_key, r);
+    return r;
+}
+
+static void* drainer_main(void* arg);
+
+static void start_drainer(void){
+    int expect = 0;
+    if (!__atomic_compare_exchange_n(&g_drainer_on, &expect, 1, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) return;
+    if (pthread_create(&g_drainer, NULL, drainer_main, NULL) != 0)
+        __atomic_store_n(&g_drainer_on, 0, __ATOMIC_RELEASE);
+}
+
+// 이 스레드의 링 (기록 준비 전이면 NULL, 처음이면 drainer 도 띄운다)
+static inline ring_t* trace_ring(void){
+    if (!g_ready) return NULL;
+    if (!__atomic_load_n(&g_drainer_on, __ATOMIC_RELAXED)) start_drainer();
+    return my_ring();
+}
+
+// 이벤트 하나 기록 (락 없음, 시스템 콜 없음). 링이 가득 차 버렸으면 0
+static inline int emit(ring_t* r, int op, int fd, uint64_t t, int64_t ret, uint32_t ep, uint16_t flags){
+    uint64_t head = r->head;
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) >= RING_SIZE){
+        __atomic_fetch_add(&r->dropped, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    event_t* e = &r->ev[head & (RING_SIZE-1)];
+    e->t_ns = t;
+    e->ret  = ret;
+    e->fd   = fd;
+    e->op   = (uint16_t)op;
+    e->flags = flags;
+    e->ep   = ep;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// 샘플링: 스레드마다 N 번에 한 번, 그리고/또는 간격마다 한 번
+static inline int sample_ok(ring_t* r, uint64_t t){
+    if (g_sample_n > 1){
+        if (++r->nth < g_sample_n) return 0;
+        r->nth = 0;
+    }
+    if (g_sample_ns){
+        if (t - r->last_t < g_sample_ns) return 0;
+        r->last_t = t;
+    }
+    return 1;
+}
+
+// 초당 예산: 모든 스레드가 같은 칸을 센다. 초가 바뀌면 먼저 본 스레드가 0으로 되돌린다
+// (t 는 호출 시작 시각이라 오래 막혔던 호출은 지난 초일 수 있으므로 앞으로만 넘긴다)
+static inline int budget_ok(uint64_t t){
+    if (!g_budget) return 1;
+    uint64_t sec = t / 1000000000ULL;
+    uint64_t cur = __atomic_load_n(&g_bud_sec, __ATOMIC_RELAXED);
+    if (sec > cur && __atomic_compare_exchange_n(&g_bud_sec, &cur, sec, 0,
+                                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        __atomic_store_n(&g_bud_used, 0, __ATOMIC_RELAXED);
+    return __atomic_add_fetch(&g_bud_used, 1, __ATOMIC_RELAXED) <= g_budget;
+}
+
+// 연결 이벤트: fd/peer 필터와 예산만 적용 (샘플링, 방향, 최소 바이트와 무관)
+static void trace_conn(int op, int fd, int64_t ret, int pass, uint32_t ep){
+    ring_t* r = trace_ring();
+    if (!r) return;
+    uint64_t t = now_ns();
+    BUMP(r->c.calls, 1);
+    if (!pass)                            BUMP(r->c.filtered, 1);
+    else if (!budget_ok(t))               BUMP(r->c.budget, 1);
+    else if (emit(r, op, fd, t, ret, ep, 0)) BUMP(r->c.kept, 1);
+}
+
+// 데이터 이벤트: 소켓이면 필터 → 샘플링 → 예산을 거쳐 기록. 처리 시간은 OVH_EVERY 번에 한 번 잰다
+// (flags 는 레코드에 그대로: mmsg 의 메시지 수)
+static inline void trace_io(int op, int fd, uint64_t t, ssize_t n, uint16_t flags){
+    fd_meta* m = socket_meta(fd);
+    if (!m) return;
+    ring_t* r = trace_ring();
+    if (!r) return;
+    uint64_t t1 = (r->c.calls & (OVH_EVERY-1)) == 0 ? now_ns() : 0;
+    BUMP(r->c.calls, 1);
+    if (!m->pass || !(g_opmask & (1u << op)) || n < g_min_bytes) BUMP(r->c.filtered, 1);
+    else if (!sample_ok(r, t))                                     BUMP(r->c.sampled, 1);
+    else if (!budget_ok(t))                                        BUMP(r->c.budget, 1);
+    else if (emit(r, op, fd, t, n, m->ep, flags))                  BUMP(r->c.kept, 1);
+    if (t1){
+        BUMP(r->c.ovh_ns, now_ns() - t1);
+        BUMP(r->c.ovh_n, 1);
+    }
+}
+
+// ---------- drainer ----------
+
+typedef struct { char buf[OUT_BUF]; size_t len; } outbuf_t;
+
+static void out_flush(outbuf_t* o){
+    if (o->len) safe_write(o->buf, o->len);
+    o->len = 0;
+}
+
+static void out_printf(outbuf_t* o, const char* fmt, ...){
+    if (o->len > OUT_BUF - 512) out_flush(o);
+    size_t cap = OUT_BUF - o->len;
+    int n = 0;
+    if (g_prefix[0]) n = snprintf(o->buf + o->len, cap, "%s", g_prefix);
+    va_list ap; va_start(ap, fmt);
+    n += vsnprintf(o->buf + o->len + n, cap - (size_t)n, fmt, ap);
+    va_end(ap);
+    if (n > 0) o->len += (size_t)n < cap ? (size_t)n : cap - 1;
+}
+
+static void format_event(outbuf_t* o, const event_t* e){
+    char la[96], pa[96];
+    const ep_slot* ep = ep_lookup(e->ep);
+    fmt_addr(pa, sizeof(pa), ep ? &ep->peer : NULL);
+    double t = e->t_ns / 1e9;
+    switch (e->op){
+    case ST_OP_CONNECT:
+    case ST_OP_ACCEPT:
+        fmt_addr(la, sizeof(la), ep ? &ep->local : NULL);
+        out_printf(o, "%s fd=%d  local=%s  peer=%s\n", ev_tags[e->op], e->fd, la, pa);
+        break;
+    case ST_OP_CONNECT_ERR:
+        out_printf(o, "%s fd=%d errno=%d\n", ev_tags[e->op], e->fd, (int)e->ret);
+        break;
+    case ST_OP_CLOSE:
+        out_printf(o, "%s fd=%d peer=%s\n", ev_tags[e->op], e->fd, pa);
+        break;
+    case ST_OP_DUP:
+        out_printf(o, "%s fd=%d -> %d peer=%s\n", ev_tags[e->op], (int)e->ret, e->fd, pa);
+        break;
+    case ST_OP_RECVMMSG:
+    case ST_OP_SENDMMSG:
+        out_printf(o, "%s t=%.6f tid=%u fd=%d bytes=%lld msgs=%u peer=%s\n",
+                   ev_tags[e->op], t, e->tid, e->fd, (long long)e->ret, e->flags, pa);
+        break;
+    default:
+        out_printf(o, "%s t=%.6f tid=%u fd=%d bytes=%lld peer=%s\n",
+                   ev_tags[e->op], t, e->tid, e->fd, (long long)e->ret, pa);
+    }
+}
+
+// ---------- 바이너리 출력 (mmap 한 파일에 레코드를 그대로 복사, 가득 차면 다음 파일로) ----------
+
+typedef struct {
+    char     path[192];                 // SOCKTRACE_BIN (비어 있으면 텍스트 모드)
+    size_t   file_size;
+    uint32_t files;
+    uint32_t seq;                       // 다음에 열 파일 순번
+    int      fd;                        // -1 = 열린 파일 없음
+    char*    map;
+    size_t   used;
+    uint32_t cur_seq1;                  // 현재 파일 순번 + 1 (정의 여부 표시용)
+} binout_t;
+
+static binout_t g_bin = { .fd = -1 };
+static uint32_t g_ep_defined[MAX_EP];   // 칸마다 "현재 파일에 정의를 쓴 끝점 ID"
+static uint32_t g_ep_defseq[MAX_EP];    //        그 파일의 cur_seq1
+
+static void bin_close(binout_t* b){
+    if (b->fd < 0) return;
+    munmap(b->map, b->file_size);
+    if (ftruncate(b->fd, (off_t)b->used) < 0) { /* 남은 0 영역은 해석기가 끝으로 본다 */ }
+    close(b->fd);
+    b->fd = -1;
+}
+
+// 다음 순번 파일을 만들어 매핑하고 헤더를 쓴다. 실패하면 텍스트 모드로 돌아간다
+static int bin_open(binout_t* b){
+    char path[256];
+    snprintf(path, sizeof(path), "%s.%d.%u", b->path, (int)getpid(), b->seq % b->files);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, (off_t)b->file_size) < 0) {
+        log_msg("socktrace: %s 열기 실패 (errno=%d), 텍스트로 기록\n", path, errno);
+        if (fd >= 0) close(fd);
+        b->path[0] = '\0';
+        return -1;
+    }
+    char* map = mmap(NULL, b->file_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        log_msg("socktrace: %s mmap 실패 (errno=%d), 텍스트로 기록\n", path, errno);
+        close(fd);
+        b->path[0] = '\0';
+        return -1;
+    }
+    madvise(map, b->file_size, MADV_SEQUENTIAL);
+
+    st_file_hdr_t* h = (st_file_hdr_t*)map;
+    struct timespec rt; clock_gettime(CLOCK_REALTIME, &rt);
+    h->magic    = ST_MAGIC;
+    h->version  = ST_VERSION;
+    h->rec_size = ST_REC_SIZE;
+    h->pid      = (uint32_t)getpid();
+    h->seq      = b->seq;
+    h->mono_ns  = now_ns();
+    h->real_ns  = (uint64_t)rt.tv_sec * 1000000000ULL + (uint64_t)rt.tv_nsec;
+    h->sample_n  = (uint32_t)g_sample_n;
+    h->sample_us = (uint32_t)(g_sample_ns / 1000);
+    h->budget    = (uint32_t)g_budget;
+    h->filtered  = g_fd_filter || g_peer_filter || g_opmask != ~0u || g_min_bytes > 0;
+
+    b->fd       = fd;
+    b->map      = map;
+    b->used     = sizeof(*h);
+    b->cur_seq1 = b->seq + 1;
+    b->seq++;
+    return 0;
+}
+
+// n 바이트 자리 확보 (필요하면 회전)
+static void* bin_reserve(binout_t* b, size_t n){
+    if (b->fd >= 0 && b->used + n > b->file_size) bin_close(b);
+    if (b->fd < 0 && bin_open(b) < 0) return NULL;
+    void* p = b->map + b->used;
+    b->used += n;
+    return p;
+}
+
+// 이 파일에서 아직 정의하지 않은 끝점이면 정의 레코드를 먼저 쓴다
+static void bin_define_ep(binout_t* b, uint32_t id){
+    uint32_t slot = id & (MAX_EP-1);
+    if (!id || (g_ep_defined[slot] == id && g_ep_defseq[slot] == b->cur_seq1)) return;
+    st_ep_rec_t* d = bin_reserve(b, sizeof(*d));
+    if (!d) return;
+    memset(d, 0, sizeof(*d));
+    d->op = ST_OP_ENDPOINT;
+    d->ep = id;
+    const ep_slot* e = ep_lookup(id);
+    if (e && e->peer.sa.sa_family == AF_INET6) {
+        d->family = AF_INET6;
+        memcpy(d->laddr, &e->local.in6.sin6_addr, 16);
+        memcpy(d->paddr, &e->peer.in6.sin6_addr,  16);
+        d->lport = ntohs(e->local.in6.sin6_port);
+        d->pport = ntohs(e->peer.in6.sin6_port);
+    } else if (e && (e->peer.sa.sa_family == AF_INET || e->local.sa.sa_family == AF_INET)) {
+        d->family = AF_INET;
+        memcpy(d->laddr, &e->local.in.sin_addr, 4);
+        memcpy(d->paddr, &e->peer.in.sin_addr,  4);
+        d->lport = ntohs(e->local.in.sin_port);
+        d->pport = ntohs(e->peer.in.sin_port);
+    }
+    g_ep_defined[slot] = id;
+    g_ep_defseq[slot]  = b->cur_seq1;
+}
+
+static void bin_event(binout_t* b, const event_t* e){
+    // 정의와 이벤트가 같은 파일에 들어가도록, 둘 다 들어갈 자리가 없으면 먼저 회전
+    if (b->fd >= 0 && b->used + sizeof(st_ep_rec_t) + sizeof(st_rec_t) > b->file_size) bin_close(b);
+    if (b->fd < 0 && bin_open(b) < 0) return;   // 정의 여부는 열린 파일 기준으로 판단
+    bin_define_ep(b, e->ep);
+    st_rec_t* r = bin_reserve(b, sizeof(*r));
+    if (r) *r = *e;
+}
+
+static void emit_out(outbuf_t* o, event_t* e){
+    if (g_bin.path[0]) bin_event(&g_bin, e);
+    else               format_event(o, e);
+}
+
+static uint64_t g_ring_lost;   // 링이 가득 차 버린 이벤트 누적 (drainer 만 씀)
+
+// 모든 링을 한 바퀴 비운다. 처리한 이벤트 수 반환
+static long drain_all(outbuf_t* o){
+    long total = 0;
+    for (ring_t* r = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE); r; r = r->next){
+        int st = __atomic_load_n(&r->state, __ATOMIC_ACQUIRE);
+        if (st == RING_FREE) continue;
+        uint64_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        uint64_t tail = r->tail;
+        for (; tail != head; tail++) {
+            event_t* e = &r->ev[tail & (RING_SIZE-1)];
+            e->tid = (uint32_t)r->tid;
+            emit_out(o, e);
+            // 한 줄 포맷할 때마다 슬롯을 돌려줘서 생산자가 덜 버리게 한다
+            __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+            total++;
+        }
+        uint64_t lost = __atomic_exchange_n(&r->dropped, 0, __ATOMIC_RELAXED);
+        g_ring_lost += lost;
+        if (lost && g_bin.path[0]) {
+            event_t d = { .op = ST_OP_DROP, .flags = ST_DROP_RING, .tid = (uint32_t)r->tid,
+                          .t_ns = now_ns(), .ret = (int64_t)lost };
+            bin_event(&g_bin, &d);
+        } else if (lost) {
+            out_printf(o, "socktrace: tid=%d 링이 가득 차 이벤트 %llu개 버림\n",
+                       r->tid, (unsigned long long)lost);
+        }
+        // 종료한 스레드의 링은 다 비웠으면 재사용 가능으로 (RETIRED 이후엔 head 가 안 바뀜)
+        if (st == RING_RETIRED && __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == r->tail)
+            __atomic_store_n(&r->state, RING_FREE, __ATOMIC_RELEASE);
+    }
+    out_flush(o);
+    return total;
+}
+
+// 예산 초과로 버린 수를 스레드별로 알린다. 이벤트마다 알리면 그게 또 부하라 drainer 가 1초에 한 번
+static void budget_drops(outbuf_t* o){
+    for (ring_t* r = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE); r; r = r->next){
+        uint64_t b = __atomic_load_n(&r->c.budget, __ATOMIC_RELAXED);
+        if (b <= r->budget_seen) continue;
+        uint64_t n = b - r->budget_seen;
+        r->budget_seen = b;
+        if (g_bin.path[0]) {
+            event_t d = { .op = ST_OP_DROP, .flags = ST_DROP_BUDGET, .tid = (uint32_t)r->tid,
+                          .t_ns = now_ns(), .ret = (int64_t)n };
+            bin_event(&g_bin, &d);
+        } else {
+            out_printf(o, "socktrace: tid=%d 초당 예산 %llu 초과로 이벤트 %llu개 버림\n",
+                       r->tid, (unsigned long long)g_budget, (unsigned long long)n);
+        }
+    }
+}
+
+// ---------- 자체 오버헤드 보고 ----------
+
+typedef struct {
+    st_count_t c;                       // 모든 링의 합
+    uint64_t   lost;                    // 링이 가득 차 버린 수
+    uint64_t   t_ns;
+    uint64_t   proc_ns;                 // 프로세스 CPU 시간
+    uint64_t   drain_ns;                // drainer 스레드 CPU 시간
+} snap_t;
+
+static snap_t   g_start, g_last;        // 시작 시점, 지난 보고 시점
+static uint64_t g_drain_cpu;            // drainer 가 마지막으로 잰 자기 CPU 시간
+
+static uint64_t cpu_ns(clockid_t clk){
+    struct timespec ts; clock_gettime(clk, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void take_snap(snap_t* s){
+    memset(s, 0, sizeof(*s));
+    for (ring_t* r = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE); r; r = r->next){
+        s->c.calls    += __atomic_load_n(&r->c.calls,    __ATOMIC_RELAXED);
+        s->c.kept     += __atomic_load_n(&r->c.kept,     __ATOMIC_RELAXED);
+        s->c.filtered += __atomic_load_n(&r->c.filtered, __ATOMIC_RELAXED);
+        s->c.sampled  += __atomic_load_n(&r->c.sampled,  __ATOMIC_RELAXED);
+        s->c.budget   += __atomic_load_n(&r->c.budget,   __ATOMIC_RELAXED);
+        s->c.ovh_ns   += __atomic_load_n(&r->c.ovh_ns,   __ATOMIC_RELAXED);
+        s->c.ovh_n    += __atomic_load_n(&r->c.ovh_n,    __ATOMIC_RELAXED);
+    }
+    s->lost     = g_ring_lost;
+    s->t_ns     = now_ns();
+    s->proc_ns  = cpu_ns(CLOCK_PROCESS_CPUTIME_ID);
+    s->drain_ns = g_drain_cpu;
+}
+
+// a → b 구간: 몇 개를 남기고 몇 개를 걸렀는지, 트레이서가 프로세스 CPU 를 얼마나 먹었는지.
+// 후킹 비용 = (잰 호출의 평균 처리 시간 + 호출 전 시각 측정) x 호출 수 (추정)
+static void report(outbuf_t* o, const snap_t* a, const snap_t* b, const char* what){
+    unsigned long long calls = b->c.calls - a->c.calls;
+    unsigned long long budget = b->c.budget - a->c.budget, lost = b->lost - a->lost;
+    uint64_t on = b->c.ovh_n - a->c.ovh_n;
+    double per_ns   = (on ? (double)(b->c.ovh_ns - a->c.ovh_ns) / on : 0.0) + (double)g_clock_ns;
+    double hook_ms  = per_ns * (double)calls / 1e6;
+    double drain_ms = (double)(b->drain_ns - a->drain_ns) / 1e6;
+    double proc_ms  = (double)(b->proc_ns - a->proc_ns) / 1e6;
+    double pct      = proc_ms > 0 ? 100.0 * (hook_ms + drain_ms) / proc_ms : 0.0;
+    out_printf(o, "socktrace: %s %.1f초: 소켓 호출 %llu, 기록 %llu (필터 제외 %llu, 샘플링 제외 %llu, "
+                  "예산 초과 %llu, 링 가득 %llu)%s\n",
+               what, (double)(b->t_ns - a->t_ns) / 1e9, calls,
+               (unsigned long long)(b->c.kept - a->c.kept),
+               (unsigned long long)(b->c.filtered - a->c.filtered),
+               (unsigned long long)(b->c.sampled - a->c.sampled), budget, lost,
+               budget + lost ? " - 버린 이벤트가 있어 이 구간 추적은 빠진 곳이 있음" : "");
+    out_printf(o, "socktrace: %s 오버헤드: 후킹 %.0fns/호출 = %.1fms, drainer CPU %.1fms "
+                  "→ 프로세스 CPU %.1fms 의 %.1f%%%s\n",
+               what, per_ns, hook_ms, drain_ms, proc_ms, pct,
+               pct > 5.0 ? " (5% 초과: 추적이 측정 대상을 바꾸고 있을 수 있음)" : "");
+}
+
+static outbuf_t g_out;   // drainer 전용 (fini 에서는 drainer 를 멈춘 뒤 사용)
+
+static void* drainer_main(void* arg){
+    (void)arg;
+    uint64_t next_sec = now_ns() + 1000000000ULL;
+    uint64_t next_rep = now_ns() + g_report_ns;
+    while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE)){
+        long n = drain_all(&g_out);
+        uint64_t t = now_ns();
+        if (g_budget && t >= next_sec){
+            budget_drops(&g_out);
+            out_flush(&g_out);
+            next_sec = t + 1000000000ULL;
+        }
+        if (g_report_ns && t >= next_rep){
+            snap_t s;
+            g_drain_cpu = cpu_ns(CLOCK_THREAD_CPUTIME_ID);
+            take_snap(&s);
+            report(&g_out, &g_last, &s, "최근");
+            out_flush(&g_out);
+            g_last   = s;
+            next_rep = t + g_report_ns;
+        }
+        if (n == 0){   // 할 일이 없을 때만 쉰다
+            struct timespec ts = { 0, DRAIN_NS };
+            nanosleep(&ts, NULL);
+        }
+    }
+    g_drain_cpu = cpu_ns(CLOCK_THREAD_CPUTIME_ID);
+    return NULL;
+}
+
+// fork 후 자식: drainer 스레드는 복제되지 않으므로 다음 이벤트 때 새로 띄운다.
+// 부모의 링에 남은 이벤트는 부모가 출력하므로 자식에서는 버린다.
+// 바이너리 파일도 부모 것이므로 매핑만 풀고, 자식은 자기 pid 이름으로 새로 연다
+static void atfork_child(void){
+    g_drainer_on = 0;
+    if (g_bin.fd >= 0) {
+        munmap(g_bin.map, g_bin.file_size);
+        close(g_bin.fd);
+        g_bin.fd  = -1;
+        g_bin.seq = 0;
+    }
+    for (ring_t* r = g_rings; r; r = r->next){
+        r->tail = r->head;
+        r->dropped = 0;
+        memset(&r->c, 0, sizeof(r->c));   // 자기 보고는 자식 것만
+        r->budget_seen = 0;
+        if (r != t_ring && r->state == RING_USED) r->state = RING_FREE;   // 다른 스레드는 자식에 없음
+    }
+    g_ring_lost = 0;
+    g_drain_cpu = 0;   // 새 drainer 스레드의 CPU 시간은 0부터
+    take_snap(&g_start);
+    g_last = g_start;
+}
+
+// "5,7-9" → g_fdmask
+static int parse_fds(const char* s){
+    while (*s){
+        char* end;
+        long a = strtol(s, &end, 10), b = a;
+        if (end == s) return -1;
+        if (*end == '-'){
+            s = end + 1;
+            b = strtol(s, &end, 10);
+            if (end == s) return -1;
+        }
+        if (a < 0 || b >= MAX_FD || a > b) return -1;
+        for (long fd = a; fd <= b; fd++) g_fdmask[fd >> 6] |= 1ULL << (fd & 63);
+        if (*end == ',') end++;
+        else if (*end) return -1;
+        s = end;
+    }
+    g_fd_filter = 1;
+    return 0;
+}
+
+// "10.0.0.2", ":8888", "10.0.0.2:8888", "::1", "[::1]:8888" → g_peer_*
+static int parse_peer(const char* s){
+    char host[INET6_ADDRSTRLEN];
+    const char* port = NULL;
+    const char* colon = strchr(s, ':');
+    if (s[0] == '['){
+        const char* e = strchr(s, ']');
+        if (!e || (e[1] && e[1] != ':')) return -1;
+        snprintf(host, sizeof(host), "%.*s", (int)(e - s - 1), s + 1);
+        if (e[1]) port = e + 2;
+    } else if (colon && colon == strrchr(s, ':')){   // 콜론 하나: 주소:포트 (주소는 생략 가능)
+        snprintf(host, sizeof(host), "%.*s", (int)(colon - s), s);
+        port = colon + 1;
+    } else {                                         // 포트 없는 IPv4 / IPv6 주소
+        snprintf(host, sizeof(host), "%s", s);
+    }
+    if (host[0]){
+        if (inet_pton(AF_INET, host, g_peer_addr) == 1)       g_peer_family = AF_INET;
+        else if (inet_pton(AF_INET6, host, g_peer_addr) == 1) g_peer_family = AF_INET6;
+        else return -1;
+    }
+    if (port){
+        int p = atoi(port);
+        if (p <= 0 || p > 65535) return -1;
+        g_peer_port = (uint16_t)p;
+    }
+    g_peer_filter = 1;
+    return 0;
+}
+
+// 필터/샘플링/예산/보고 env 읽기. 잘못된 값은 알리고 무시
+static void read_filters(void){
+    const char* v;
+    if ((v = getenv("SOCKTRACE_FD")) && *v && parse_fds(v) < 0){
+        log_msg("socktrace: SOCKTRACE_FD=%s 무시 (예: 5,7-9, 0 ~ %d)\n", v, MAX_FD - 1);
+        memset(g_fdmask, 0, sizeof(g_fdmask));
+        g_fd_filter = 0;
+    }
+    if ((v = getenv("SOCKTRACE_PEER")) && *v && parse_peer(v) < 0){
+        log_msg("socktrace: SOCKTRACE_PEER=%s 무시 (예: 10.0.0.2, :8888, 10.0.0.2:8888, [::1]:8888)\n", v);
+        g_peer_filter = g_peer_family = g_peer_port = 0;
+    }
+    if ((v = getenv("SOCKTRACE_DIR")) && *v){
+        if (strcmp(v, "in") == 0)       g_opmask = ST_IN_MASK;
+        else if (strcmp(v, "out") == 0) g_opmask = ST_OUT_MASK;
+        else log_msg("socktrace: SOCKTRACE_DIR=%s 무시 (in|out)\n", v);
+    }
+    if ((v = getenv("SOCKTRACE_MIN_BYTES")) && *v) g_min_bytes = atoll(v);
+    if ((v = getenv("SOCKTRACE_SAMPLE")) && *v)    g_sample_n  = (uint64_t)atoll(v);
+    if ((v = getenv("SOCKTRACE_SAMPLE_US")) && *v) g_sample_ns = (uint64_t)atoll(v) * 1000;
+    if ((v = getenv("SOCKTRACE_BUDGET")) && *v)    g_budget    = (uint64_t)atoll(v);
+    if ((v = getenv("SOCKTRACE_REPORT_SEC")) && *v) g_report_ns = (uint64_t)(atof(v) * 1e9);
+
+    // 후킹은 호출 전에 now_ns 를 한 번 부른다. 그 비용은 재는 구간 밖이라 따로 잰다
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < 1000; i++) (void)now_ns();
+    g_clock_ns = (now_ns() - t0) / 1000;
 }
 
 // 라이브러리 로드 시 초기화(생성자)
@@ -134,74 +834,190 @@ static void init(void){
     real_recv    = dlsym(RTLD_NEXT, "recv");
     real_connect = dlsym(RTLD_NEXT, "connect");
     real_accept  = dlsym(RTLD_NEXT, "accept");
+    real_accept4 = dlsym(RTLD_NEXT, "accept4");
+    real_readv   = dlsym(RTLD_NEXT, "readv");
+    real_writev  = dlsym(RTLD_NEXT, "writev");
+    real_recvmsg = dlsym(RTLD_NEXT, "recvmsg");
+    real_sendmsg = dlsym(RTLD_NEXT, "sendmsg");
+    real_recvmmsg = dlsym(RTLD_NEXT, "recvmmsg");
+    real_sendmmsg = dlsym(RTLD_NEXT, "sendmmsg");
+    real_sendfile = dlsym(RTLD_NEXT, "sendfile");
+    real_sendfile64 = dlsym(RTLD_NEXT, "sendfile64");
+    real_splice  = dlsym(RTLD_NEXT, "splice");
+    real_close   = dlsym(RTLD_NEXT, "close");
+    real_dup     = dlsym(RTLD_NEXT, "dup");
+    real_dup2    = dlsym(RTLD_NEXT, "dup2");
+    real_dup3    = dlsym(RTLD_NEXT, "dup3");
 
     // 로그 접두사 환경변수
     const char* p = getenv("SOCKTRACE_PREFIX");
     if (p && *p) snprintf(g_prefix, sizeof(g_prefix), "%s", p);
 
-    logf("socktrace: loaded (prefix=%s)\n", g_prefix[0]?g_prefix:"<none>");
+    // 바이너리 출력 설정
+    const char* bin = getenv("SOCKTRACE_BIN");
+    if (bin && *bin) {
+        const char* mb = getenv("SOCKTRACE_BIN_MB");
+        const char* nf = getenv("SOCKTRACE_BIN_FILES");
+        snprintf(g_bin.path, sizeof(g_bin.path), "%s", bin);
+        g_bin.file_size = (size_t)(mb && atoi(mb) > 0 ? atoi(mb) : 64) * 1024 * 1024;
+        g_bin.files     = (uint32_t)(nf && atoi(nf) > 0 ? atoi(nf) : 4);
+    }
+
+    read_filters();
+    take_snap(&g_start);
+    g_last = g_start;
+
+    pthread_key_create(&g_key, ring_release);
+    pthread_atfork(NULL, NULL, atfork_child);
+    g_ready = 1;
+
+    log_msg("socktrace: loaded (prefix=%s, out=%s)\n", g_prefix[0]?g_prefix:"<none>",
+            g_bin.path[0]?g_bin.path:"stderr");
+    if (g_fd_filter || g_peer_filter || g_opmask != ~0u || g_min_bytes > 0 || g_sample_n > 1 ||
+        g_sample_ns || g_budget)
+        log_msg("socktrace: 필터 fd=%s peer=%s dir=%s min=%lld, 샘플 1/%llu %lluus, 예산 %llu/s\n",
+                g_fd_filter ? getenv("SOCKTRACE_FD") : "*", g_peer_filter ? getenv("SOCKTRACE_PEER") : "*",
+                g_opmask == ~0u ? "*" : getenv("SOCKTRACE_DIR"), (long long)g_min_bytes,
+                (unsigned long long)(g_sample_n > 1 ? g_sample_n : 1),
+                (unsigned long long)(g_sample_ns / 1000), (unsigned long long)g_budget);
 }
 
-// 언로드 시(소멸자)
+// 언로드 시(소멸자): drainer 를 멈추고 남은 이벤트를 마저 출력
 __attribute__((destructor))
 static void fini(void){
-    logf("socktrace: bye\n");
-}
-
-// 5-튜플(로컬/피어) 한 줄로 출력
-static void print_5tuple(int fd, const char* tag){
-    char la[96], pa[96];
-    fmt_addr(la, sizeof(la), &M[fd].local);
-    fmt_addr(pa, sizeof(pa), &M[fd].peer);
-    logf("%s fd=%d  local=%s  peer=%s\n", tag, fd, la, pa);
+    if (__atomic_load_n(&g_drainer_on, __ATOMIC_ACQUIRE)){
+        __atomic_store_n(&g_stop, 1, __ATOMIC_RELEASE);
+        pthread_join(g_drainer, NULL);
+        g_drainer_on = 0;
+    }
+    g_ready = 0;
+    drain_all(&g_out);
+    budget_drops(&g_out);
+    snap_t s;
+    take_snap(&s);
+    report(&g_out, &g_start, &s, "전체");
+    out_flush(&g_out);
+    bin_close(&g_bin);
+    log_msg("socktrace: bye\n");
 }
 
 // -------------------- 후킹 함수들 --------------------
 
-// connect: 클라이언트가 서버로 접속 시도
+// connect: 클라이언트가 서버로 접속 시도. 성공하면 주소를 조회해 캐시
 int connect(int fd, const struct sockaddr* addr, socklen_t len){
     if (!real_connect) real_connect = dlsym(RTLD_NEXT, "connect");
     int r = real_connect(fd, addr, len);
-    pthread_mutex_lock(&g_lock);
-    ensure_fd(fd);
-    if (r==0 && M[fd].is_socket){
-        refresh_endpoints(fd);          // 연결 성공 후 최신 주소 반영
-        print_5tuple(fd, "[connect ok]");
-    } else if (r<0) {
-        logf("[connect err] fd=%d errno=%d\n", fd, errno);
-    }
-    pthread_mutex_unlock(&g_lock);
+    int err = errno;
+    if (fd>=0 && fd<MAX_FD){
+        if (r==0){
+            capture_endpoints(fd);
+            trace_conn(ST_OP_CONNECT, fd, 0, M[fd].pass, M[fd].ep);
+        } else {
+            addr_t a;   // 실패한 연결은 끝점이 없으므로 시도한 주소로 필터
+            memset(&a, 0, sizeof(a));
+            if (addr) memcpy(&a, addr, len < sizeof(a) ? len : sizeof(a));
+            trace_conn(ST_OP_CONNECT_ERR, fd, err, fd_match(fd) && peer_match(&a), 0);
+        }
+    }
+    errno = err;
     return r;
 }
 
-// accept: 서버가 새 연결 수락
+// 새로 받은 연결: 주소를 조회해 캐시 (accept / accept4 공통)
+static void accepted(int cfd){
+    if (cfd<0 || cfd>=MAX_FD) return;
+    int err = errno;
+    capture_endpoints(cfd);
+    trace_conn(ST_OP_ACCEPT, cfd, 0, M[cfd].pass, M[cfd].ep);
+    errno = err;
+}
+
+// accept: 서버가 새 연결 수락. 새 FD의 주소를 조회해 캐시
 int accept(int fd, struct sockaddr* addr, socklen_t* len){
     if (!real_accept) real_accept = dlsym(RTLD_NEXT, "accept");
     int cfd = real_accept(fd, addr, len);
-    if (cfd>=0){
-        pthread_mutex_lock(&g_lock);
-        ensure_fd(cfd);                 // 새 FD 메타 준비
-        refresh_endpoints(cfd);         // 로컬/피어 주소 기록
-        print_5tuple(cfd, "[accept ok]");
-        pthread_mutex_unlock(&g_lock);
-    }
+    accepted(cfd);
     return cfd;
 }
 
+// accept4: SOCK_NONBLOCK/SOCK_CLOEXEC 를 한 번에 거는 accept (epoll 서버가 주로 씀)
+int accept4(int fd, struct sockaddr* addr, socklen_t* len, int flags){
+    if (!real_accept4) real_accept4 = dlsym(RTLD_NEXT, "accept4");
+    int cfd = real_accept4(fd, addr, len, flags);
+    accepted(cfd);
+    return cfd;
+}
+
+// FD 가 닫힘: 소켓이었으면 기록하고 메타를 비운다 (같은 번호가 재사용되면 새 끝점으로 잡히게)
+static void forget_fd(int fd){
+    if (fd<0 || fd>=MAX_FD) return;
+    int err = errno;
+    int st = __atomic_load_n(&M[fd].state, __ATOMIC_ACQUIRE);
+    if (st == FD_SOCKET) trace_conn(ST_OP_CLOSE, fd, 0, M[fd].pass, M[fd].ep);
+    if (st != FD_UNKNOWN) __atomic_store_n(&M[fd].state, FD_UNKNOWN, __ATOMIC_RELEASE);
+    errno = err;
+}
+
+// dup 류로 생긴 새 FD: 같은 소켓이므로 끝점 ID와 필터 결과를 물려준다
+static void dup_fd(int oldfd, int newfd){
+    if (newfd<0 || newfd>=MAX_FD) return;
+    int err = errno;
+    fd_meta* m = socket_meta(oldfd);
+    if (m){
+        M[newfd].ep   = m->ep;
+        M[newfd].pass = m->pass;
+        __atomic_store_n(&M[newfd].state, FD_SOCKET, __ATOMIC_RELEASE);
+        trace_conn(ST_OP_DUP, newfd, oldfd, m->pass, m->ep);
+    } else {
+        __atomic_store_n(&M[newfd].state, FD_UNKNOWN, __ATOMIC_RELEASE);   // 처음 쓸 때 다시 판별
+    }
+    errno = err;
+}
+
+// close: 닫기 전에 메타를 비운다 (닫은 직후 다른 스레드가 같은 FD를 받을 수 있음)
+int close(int fd){
+    if (!real_close) real_close = dlsym(RTLD_NEXT, "close");
+    forget_fd(fd);
+    return real_close(fd);
+}
+
+int dup(int oldfd){
+    if (!real_dup) real_dup = dlsym(RTLD_NEXT, "dup");
+    int r = real_dup(oldfd);
+    if (r>=0) dup_fd(oldfd, r);
+    return r;
+}
+
+// dup2/dup3: newfd 가 열려 있었으면 암묵적으로 닫힌다
+int dup2(int oldfd, int newfd){
+    if (!real_dup2) real_dup2 = dlsym(RTLD_NEXT, "dup2");
+    int r = real_dup2(oldfd, newfd);
+    if (r>=0 && oldfd != newfd){
+        forget_fd(newfd);
+        dup_fd(oldfd, newfd);
+    }
+    return r;
+}
+
+int dup3(int oldfd, int newfd, int flags){
+    if (!real_dup3) real_dup3 = dlsym(RTLD_NEXT, "dup3");
+    int r = real_dup3(oldfd, newfd, flags);
+    if (r>=0){
+        forget_fd(newfd);
+        dup_fd(oldfd, newfd);
+    }
+    return r;
+}
+
 // send: TCP/UDP 송신 (flags는 그대로 전달)
 ssize_t send(int fd, const void* buf, size_t cnt, int flags){
     if (!real_send) real_send = dlsym(RTLD_NEXT, "send");
-    double t = now_s();
+    uint64_t t = now_ns();
     ssize_t n = real_send(fd, buf, cnt, flags);
     if (n>=0){
-        pthread_mutex_lock(&g_lock);
-        ensure_fd(fd);
-        if (M[fd].is_socket){
-            refresh_endpoints(fd);
-            char pa[96]; fmt_addr(pa, sizeof(pa), &M[fd].peer);
-            logf("[send]  t=%.6f fd=%d bytes=%zd peer=%s\n", t, fd, n, pa);
-        }
-        pthread_mutex_unlock(&g_lock);
+        int err = errno;
+        trace_io(ST_OP_SEND, fd, t, n, 0);
+        errno = err;
     }
     return n;
 }
@@ -209,17 +1025,12 @@ ssize_t send(int fd, const void* buf, size_t cnt, int flags){
 // recv: TCP/UDP 수신
 ssize_t recv(int fd, void* buf, size_t cnt, int flags){
     if (!real_recv) real_recv = dlsym(RTLD_NEXT, "recv");
-    double t = now_s();
+    uint64_t t = now_ns();
     ssize_t n = real_recv(fd, buf, cnt, flags);
-    if (n>=0){
-        pthread_mutex_lock(&g_lock);
-        ensure_fd(fd);
-        if (M[fd].is_socket){
-            refresh_endpoints(fd);
-            char pa[96]; fmt_addr(pa, sizeof(pa), &M[fd].peer);
-            logf("[recv]  t=%.6f fd=%d bytes=%zd peer=%s\n", t, fd, n, pa);
-        }
-        pthread_mutex_unlock(&g_lock);
+    if (n>=0 && !(flags & MSG_PEEK)){   // PEEK 는 소비하지 않으므로 제외 (실제로 읽을 때 센다, netprof 와 같음)
+        int err = errno;
+        trace_io(ST_OP_RECV, fd, t, n, 0);
+        errno = err;
     }
     return n;
 }
@@ -227,17 +1038,12 @@ ssize_t recv(int fd, void* buf, size_t cnt, int flags){
 // read: 소켓인지 확인하고 소켓이면 로깅(read를 쓰는 앱 호환)
 ssize_t read(int fd, void* buf, size_t cnt){
     if (!real_read) real_read = dlsym(RTLD_NEXT, "read");
-    double t = now_s();
+    uint64_t t = now_ns();
     ssize_t n = real_read(fd, buf, cnt);
     if (n>=0){
-        pthread_mutex_lock(&g_lock);
-        ensure_fd(fd);
-        if (M[fd].is_socket){
-            refresh_endpoints(fd);
-            char pa[96]; fmt_addr(pa, sizeof(pa), &M[fd].peer);
-            logf("[read]  t=%.6f fd=%d bytes=%zd peer=%s\n", t, fd, n, pa);
-        }
-        pthread_mutex_unlock(&g_lock);
+        int err = errno;
+        trace_io(ST_OP_READ, fd, t, n, 0);
+        errno = err;
     }
     return n;
 }
@@ -245,17 +1051,133 @@ ssize_t read(int fd, void* buf, size_t cnt){
 // write: 소켓이면 로깅(write를 쓰는 앱 호환)
 ssize_t write(int fd, const void* buf, size_t cnt){
     if (!real_write) real_write = dlsym(RTLD_NEXT, "write");
-    double t = now_s();
+    uint64_t t = now_ns();
     ssize_t n = real_write(fd, buf, cnt);
     if (n>=0){
-        pthread_mutex_lock(&g_lock);
-        ensure_fd(fd);
-        if (M[fd].is_socket){
-            refresh_endpoints(fd);
-            char pa[96]; fmt_addr(pa, sizeof(pa), &M[fd].peer);
-            logf("[write] t=%.6f fd=%d bytes=%zd peer=%s\n", t, fd, n, pa);
-        }
-        pthread_mutex_unlock(&g_lock);
+        int err = errno;
+        trace_io(ST_OP_WRITE, fd, t, n, 0);
+        errno = err;
+    }
+    return n;
+}
+
+// readv/writev: 바이트는 모든 iovec 합 (반환값 그대로)
+ssize_t readv(int fd, const struct iovec* iov, int iovcnt){
+    if (!real_readv) real_readv = dlsym(RTLD_NEXT, "readv");
+    uint64_t t = now_ns();
+    ssize_t n = real_readv(fd, iov, iovcnt);
+    if (n>=0){
+        int err = errno;
+        trace_io(ST_OP_READV, fd, t, n, 0);
+        errno = err;
+    }
+    return n;
+}
+
+ssize_t writev(int fd, const struct iovec* iov, int iovcnt){
+    if (!real_writev) real_writev = dlsym(RTLD_NEXT, "writev");
+    uint64_t t = now_ns();
+    ssize_t n = real_writev(fd, iov, iovcnt);
+    if (n>=0){
+        int err = errno;
+        trace_io(ST_OP_WRITEV, fd, t, n, 0);
+        errno = err;
+    }
+    return n;
+}
+
+ssize_t recvmsg(int fd, struct msghdr* msg, int flags){
+    if (!real_recvmsg) real_recvmsg = dlsym(RTLD_NEXT, "recvmsg");
+    uint64_t t = now_ns();
+    ssize_t n = real_recvmsg(fd, msg, flags);
+    if (n>=0 && !(flags & MSG_PEEK)){
+        int err = errno;
+        trace_io(ST_OP_RECVMSG, fd, t, n, 0);
+        errno = err;
+    }
+    return n;
+}
+
+ssize_t sendmsg(int fd, const struct msghdr* msg, int flags){
+    if (!real_sendmsg) real_sendmsg = dlsym(RTLD_NEXT, "sendmsg");
+    uint64_t t = now_ns();
+    ssize_t n = real_sendmsg(fd, msg, flags);
+    if (n>=0){
+        int err = errno;
+        trace_io(ST_OP_SENDMSG, fd, t, n, 0);
+        errno = err;
+    }
+    return n;
+}
+
+// 처리한 메시지 n 개의 바이트 합 (반환값은 메시지 수라 바이트가 아님)
+static ssize_t mmsg_bytes(const struct mmsghdr* v, int n){
+    ssize_t sum = 0;
+    for (int i = 0; i < n; i++) sum += v[i].msg_len;
+    return sum;
+}
+
+// recvmmsg/sendmmsg: 한 번의 호출로 여러 메시지. 이벤트 하나에 바이트 합과 메시지 수
+int recvmmsg(int fd, struct mmsghdr* vec, unsigned int vlen, int flags, struct timespec* timeout){
+    if (!real_recvmmsg) real_recvmmsg = dlsym(RTLD_NEXT, "recvmmsg");
+    uint64_t t = now_ns();
+    int n = real_recvmmsg(fd, vec, vlen, flags, timeout);
+    if (n>=0 && !(flags & MSG_PEEK)){
+        int err = errno;
+        trace_io(ST_OP_RECVMMSG, fd, t, mmsg_bytes(vec, n), (uint16_t)(n > 0xffff ? 0xffff : n));
+        errno = err;
+    }
+    return n;
+}
+
+int sendmmsg(int fd, struct mmsghdr* vec, unsigned int vlen, int flags){
+    if (!real_sendmmsg) real_sendmmsg = dlsym(RTLD_NEXT, "sendmmsg");
+    uint64_t t = now_ns();
+    int n = real_sendmmsg(fd, vec, vlen, flags);
+    if (n>=0){
+        int err = errno;
+        trace_io(ST_OP_SENDMMSG, fd, t, mmsg_bytes(vec, n), (uint16_t)(n > 0xffff ? 0xffff : n));
+        errno = err;
+    }
+    return n;
+}
+
+// sendfile: 파일 → 소켓 (zero-copy). 소켓 쪽 FD 로 기록
+ssize_t sendfile(int out_fd, int in_fd, off_t* off, size_t cnt){
+    if (!real_sendfile) real_sendfile = dlsym(RTLD_NEXT, "sendfile");
+    uint64_t t = now_ns();
+    ssize_t n = real_sendfile(out_fd, in_fd, off, cnt);
+    if (n>=0){
+        int err = errno;
+        trace_io(ST_OP_SENDFILE, out_fd, t, n, 0);
+        errno = err;
+    }
+    return n;
+}
+
+// _FILE_OFFSET_BITS=64 로 빌드한 앱은 sendfile 대신 이 이름을 부른다
+ssize_t sendfile64(int out_fd, int in_fd, off64_t* off, size_t cnt){
+    if (!real_sendfile64) real_sendfile64 = dlsym(RTLD_NEXT, "sendfile64");
+    uint64_t t = now_ns();
+    ssize_t n = real_sendfile64(out_fd, in_fd, off, cnt);
+    if (n>=0){
+        int err = errno;
+        trace_io(ST_OP_SENDFILE, out_fd, t, n, 0);
+        errno = err;
+    }
+    return n;
+}
+
+// splice: 한쪽은 파이프. 소켓 → 파이프면 수신, 파이프 → 소켓이면 송신으로 기록
+ssize_t splice(int fd_in, loff_t* off_in, int fd_out, loff_t* off_out, size_t len, unsigned int flags){
+    if (!real_splice) real_splice = dlsym(RTLD_NEXT, "splice");
+    uint64_t t = now_ns();
+    ssize_t n = real_splice(fd_in, off_in, fd_out, off_out, len, flags);
+    if (n>=0){
+        int err = errno;
+        trace_io(ST_OP_SPLICE_IN, fd_in, t, n, 0);
+        trace_io(ST_OP_SPLICE_OUT, fd_out, t, n, 0);
+        errno = err;
     }
     return n;
 }
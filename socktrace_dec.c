@@ -0,0 +1,280 @@
+// build:  make socktrace_dec
+// run  :  ./socktrace_dec /tmp/st.*              (실시간 모드와 같은 텍스트)
+//         ./socktrace_dec -f csv /tmp/st.*       (이벤트마다 CSV 한 줄)
+//         ./socktrace_dec -f conn /tmp/st.*      (연결(끝점)별 요약)
+//
+// socktrace 의 바이너리 추적 파일(SOCKTRACE_BIN)을 해석한다. 형식은 socktrace_fmt.h.
+// 파일은 (pid, seq) 순으로 정렬해서 읽으므로 셸 glob 순서와 상관없다.
+// 회전으로 앞 파일이 덮어써졌으면 남은 파일만 해석한다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+
+#include "socktrace_fmt.h"
+
+enum { F_TEXT, F_CSV, F_CONN };
+
+static const char* op_names[ST_OP_COUNT] = {
+    "end", "connect", "connect_err", "accept", "send", "recv", "read", "write", "drop", "endpoint",
+    "readv", "writev", "recvmsg", "sendmsg", "recvmmsg", "sendmmsg", "sendfile", "splice_in", "splice_out",
+    "close", "dup"
+};
+static const char* op_tags[ST_OP_COUNT] = {
+    "", "[connect ok]", "[connect err]", "[accept ok]", "[send] ", "[recv] ", "[read] ", "[write]", "", "",
+    "[readv]", "[writev]", "[recvmsg]", "[sendmsg]", "[recvmmsg]", "[sendmmsg]", "[sendfile]",
+    "[splice in]", "[splice out]", "[close]", "[dup]"
+};
+
+typedef struct {
+    const char*          path;
+    const unsigned char* map;
+    size_t               len;
+    const st_file_hdr_t* hdr;
+} tfile_t;
+
+// 끝점별 상태 (ID로 바로 찾도록 배열, pid 가 바뀌면 비운다)
+typedef struct {
+    int      defined;
+    char     local[64], peer[64];
+    uint64_t first_ns, last_ns;
+    long     calls[ST_OP_COUNT];
+    long long bytes_in, bytes_out;
+    long     eof;                  // 0바이트 read/recv (상대가 닫음)
+} ep_t;
+
+static ep_t*  g_ep;
+static size_t g_ep_cap;
+static int    g_fmt = F_TEXT;
+static long   g_dropped;
+static long   g_budget_dropped;
+static const st_file_hdr_t* g_partial;   // 샘플링/예산/필터를 건 추적 파일 (하나라도 있으면 알림)
+
+static ep_t* ep_get(uint32_t id) {
+    if (id >= g_ep_cap) {
+        size_t cap = g_ep_cap ? g_ep_cap : 1024;
+        while (cap <= id) cap *= 2;
+        ep_t* n = realloc(g_ep, cap * sizeof(ep_t));
+        if (!n) {
+            perror("realloc 실패");
+            exit(1);
+        }
+        memset(n + g_ep_cap, 0, (cap - g_ep_cap) * sizeof(ep_t));
+        g_ep = n;
+        g_ep_cap = cap;
+    }
+    return &g_ep[id];
+}
+
+static void fmt_ep_addr(char* out, size_t cap, int family, const uint8_t* addr, uint16_t port) {
+    char ip[INET6_ADDRSTRLEN];
+    if (family == AF_INET) {
+        inet_ntop(AF_INET, addr, ip, sizeof(ip));
+        snprintf(out, cap, "%s:%u", ip, port);
+    } else if (family == AF_INET6) {
+        inet_ntop(AF_INET6, addr, ip, sizeof(ip));
+        snprintf(out, cap, "[%s]:%u", ip, port);
+    } else {
+        snprintf(out, cap, "?");
+    }
+}
+
+static void define_ep(const st_ep_rec_t* d) {
+    ep_t* e = ep_get(d->ep);
+    if (e->defined) return;   // 회전된 파일마다 다시 나오는 정의
+    e->defined = 1;
+    fmt_ep_addr(e->local, sizeof(e->local), d->family, d->laddr, d->lport);
+    fmt_ep_addr(e->peer,  sizeof(e->peer),  d->family, d->paddr, d->pport);
+}
+
+static void on_event(const st_file_hdr_t* h, const st_rec_t* r) {
+    ep_t* e = r->ep ? ep_get(r->ep) : NULL;
+    const char* local = e && e->defined ? e->local : "?";
+    const char* peer  = e && e->defined ? e->peer  : "?";
+
+    if (r->op == ST_OP_DROP && r->flags == ST_DROP_BUDGET) g_budget_dropped += r->ret;
+    else if (r->op == ST_OP_DROP)                         g_dropped += r->ret;
+
+    if (e) {   // 연결별 누적
+        if (!e->first_ns) e->first_ns = r->t_ns;
+        e->last_ns = r->t_ns;
+        e->calls[r->op]++;
+        if (ST_OUT_MASK & (1u << r->op)) e->bytes_out += r->ret;
+        if (ST_IN_MASK & (1u << r->op)) {
+            e->bytes_in += r->ret;
+            if (r->ret == 0) e->eof++;
+        }
+    }
+
+    if (g_fmt == F_CSV) {
+        double real = (h->real_ns + (double)((int64_t)(r->t_ns - h->mono_ns))) / 1e9;
+        printf("%u,%.9f,%.6f,%u,%s,%d,%u,%lld,%s,%s\n", h->pid, r->t_ns / 1e9, real, r->tid,
+               op_names[r->op], r->fd, r->ep, (long long)r->ret, local, peer);
+    } else if (g_fmt == F_TEXT) {
+        switch (r->op) {
+        case ST_OP_CONNECT:
+        case ST_OP_ACCEPT:
+            printf("%s fd=%d  local=%s  peer=%s\n", op_tags[r->op], r->fd, local, peer);
+            break;
+        case ST_OP_CONNECT_ERR:
+            printf("%s fd=%d errno=%d\n", op_tags[r->op], r->fd, (int)r->ret);
+            break;
+        case ST_OP_CLOSE:
+            printf("%s fd=%d peer=%s\n", op_tags[r->op], r->fd, peer);
+            break;
+        case ST_OP_DUP:
+            printf("%s fd=%d -> %d peer=%s\n", op_tags[r->op], (int)r->ret, r->fd, peer);
+            break;
+        case ST_OP_RECVMMSG:
+        case ST_OP_SENDMMSG:
+            printf("%s t=%.6f tid=%u fd=%d bytes=%lld msgs=%u peer=%s\n",
+                   op_tags[r->op], r->t_ns / 1e9, r->tid, r->fd, (long long)r->ret, r->flags, peer);
+            break;
+        case ST_OP_DROP:
+            if (r->flags == ST_DROP_BUDGET)
+                printf("socktrace: tid=%u 초당 예산 %u 초과로 이벤트 %lld개 버림\n", r->tid, h->budget,
+                       (long long)r->ret);
+            else
+                printf("socktrace: tid=%u 링이 가득 차 이벤트 %lld개 버림\n", r->tid, (long long)r->ret);
+            break;
+        default:
+            printf("%s t=%.6f tid=%u fd=%d bytes=%lld peer=%s\n",
+                   op_tags[r->op], r->t_ns / 1e9, r->tid, r->fd, (long long)r->ret, peer);
+        }
+    }
+}
+
+// 파일 하나의 레코드를 차례로 처리
+static void decode_file(const tfile_t* f) {
+    size_t off = sizeof(st_file_hdr_t);
+    while (off + ST_REC_SIZE <= f->len) {
+        const st_rec_t* r = (const st_rec_t*)(f->map + off);
+        if (r->op == ST_OP_END) break;
+        if (r->op >= ST_OP_COUNT) {
+            fprintf(stderr, "%s: 오프셋 %zu 에서 알 수 없는 레코드 %u, 나머지 무시\n", f->path, off, r->op);
+            break;
+        }
+        if (r->op == ST_OP_ENDPOINT) {
+            if (off + sizeof(st_ep_rec_t) > f->len) break;
+            define_ep((const st_ep_rec_t*)r);
+            off += sizeof(st_ep_rec_t);
+            continue;
+        }
+        on_event(f->hdr, r);
+        off += ST_REC_SIZE;
+    }
+}
+
+// 한 프로세스(pid)의 연결별 요약
+static void print_conn_summary(uint32_t pid) {
+    for (size_t id = 1; id < g_ep_cap; id++) {
+        ep_t* e = &g_ep[id];
+        if (!e->defined && !e->first_ns) continue;
+        long in_calls = 0, out_calls = 0;
+        for (int op = 0; op < ST_OP_COUNT; op++) {
+            if (ST_IN_MASK & (1u << op))  in_calls  += e->calls[op];
+            if (ST_OUT_MASK & (1u << op)) out_calls += e->calls[op];
+        }
+        double dur = e->last_ns > e->first_ns ? (e->last_ns - e->first_ns) / 1e9 : 0.0;
+        printf("%-7u %-6zu %-22s %-22s %10.6f %8ld %14lld %8ld %14lld %4ld\n", pid, id,
+               e->defined ? e->local : "?", e->defined ? e->peer : "?", dur,
+               in_calls, e->bytes_in, out_calls, e->bytes_out, e->eof);
+    }
+}
+
+static int cmp_file(const void* a, const void* b) {
+    const st_file_hdr_t* x = ((const tfile_t*)a)->hdr;
+    const st_file_hdr_t* y = ((const tfile_t*)b)->hdr;
+    if (x->pid != y->pid) return x->pid < y->pid ? -1 : 1;
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "f:")) != -1) {
+        if (opt == 'f' && strcmp(optarg, "text") == 0)      g_fmt = F_TEXT;
+        else if (opt == 'f' && strcmp(optarg, "csv") == 0)  g_fmt = F_CSV;
+        else if (opt == 'f' && strcmp(optarg, "conn") == 0) g_fmt = F_CONN;
+        else {
+            fprintf(stderr, "사용법: %s [-f text|csv|conn] 추적파일...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "사용법: %s [-f text|csv|conn] 추적파일...\n", argv[0]);
+        return 1;
+    }
+
+    int nfiles = 0;
+    tfile_t* files = calloc((size_t)(argc - optind), sizeof(tfile_t));
+    if (!files) {
+        perror("calloc 실패");
+        return 1;
+    }
+    for (int i = optind; i < argc; i++) {
+        int fd = open(argv[i], O_RDONLY);
+        struct stat sb;
+        if (fd < 0 || fstat(fd, &sb) < 0) {
+            perror(argv[i]);
+            if (fd >= 0) close(fd);
+            continue;
+        }
+        if ((size_t)sb.st_size < sizeof(st_file_hdr_t)) {
+            fprintf(stderr, "%s: 추적 파일이 아님 (너무 짧음)\n", argv[i]);
+            close(fd);
+            continue;
+        }
+        void* map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            perror(argv[i]);
+            continue;
+        }
+        const st_file_hdr_t* h = map;
+        if (h->magic != ST_MAGIC || h->version < 1 || h->version > ST_VERSION || h->rec_size != ST_REC_SIZE) {
+            fprintf(stderr, "%s: 추적 파일이 아니거나 버전이 다름\n", argv[i]);
+            munmap(map, (size_t)sb.st_size);
+            continue;
+        }
+        files[nfiles++] = (tfile_t){ argv[i], map, (size_t)sb.st_size, h };
+        if (h->sample_n > 1 || h->sample_us || h->budget || h->filtered) g_partial = h;
+    }
+    qsort(files, (size_t)nfiles, sizeof(tfile_t), cmp_file);
+
+    if (g_fmt == F_CSV)
+        printf("pid,mono_s,real_s,tid,op,fd,ep,ret,local,peer\n");
+    if (g_fmt == F_CONN)
+        printf("%-7s %-6s %-22s %-22s %10s %8s %14s %8s %14s %4s\n", "pid", "ep", "local", "peer",
+               "dur_s", "in_calls", "in_bytes", "out_calls", "out_bytes", "eof");
+
+    for (int i = 0; i < nfiles; i++) {
+        // 같은 pid 의 파일이 seq 순으로 이어진다. 순번이 비면 회전으로 덮어써진 구간
+        if (i > 0 && files[i].hdr->pid == files[i-1].hdr->pid &&
+            files[i].hdr->seq != files[i-1].hdr->seq + 1)
+            fprintf(stderr, "pid %u: seq %u..%u 없음 (덮어써졌거나 빠짐)\n", files[i].hdr->pid,
+                    files[i-1].hdr->seq + 1, files[i].hdr->seq - 1);
+        decode_file(&files[i]);
+        if (i + 1 == nfiles || files[i+1].hdr->pid != files[i].hdr->pid) {
+            if (g_fmt == F_CONN) print_conn_summary(files[i].hdr->pid);
+            if (g_ep) memset(g_ep, 0, g_ep_cap * sizeof(ep_t));   // 끝점 ID는 프로세스마다 따로
+        }
+    }
+    if (g_dropped)
+        fprintf(stderr, "링이 가득 차 버려진 이벤트: %ld개\n", g_dropped);
+    if (g_budget_dropped)
+        fprintf(stderr, "초당 예산 초과로 버려진 이벤트: %ld개\n", g_budget_dropped);
+    if (g_partial)   // 연결별 호출 수/바이트가 실제보다 작게 나온다
+        fprintf(stderr, "주의: 일부만 기록한 추적 (샘플 1/%u, %uus, 예산 %u/s%s) - 합계는 실제보다 작음\n",
+                g_partial->sample_n > 1 ? g_partial->sample_n : 1, g_partial->sample_us, g_partial->budget,
+                g_partial->filtered ? ", 필터 있음" : "");
+
+    for (int i = 0; i < nfiles; i++) munmap((void*)files[i].map, files[i].len);
+    free(files);
+    free(g_ep);
+    return 0;
+}
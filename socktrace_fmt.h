@@ -0,0 +1,91 @@
+// socktrace 바이너리 추적 파일 형식 (socktrace.c 가 쓰고 socktrace_dec.c 가 읽음)
+//
+// 파일 = st_file_hdr_t (64바이트) + 레코드들. 레코드는 32바이트 단위이고 첫 2바이트가 op.
+//   op == ST_OP_ENDPOINT 인 레코드만 64바이트(두 칸)이며 끝점 ID → 로컬/피어 주소 정의.
+//   op == 0 이 나오면 파일의 유효 데이터 끝 (미리 잡아 둔 영역의 나머지).
+// 끝점 ID는 connect/accept(또는 처음 본 소켓)마다 새로 붙는 번호이고, 각 파일 안에서
+// 처음 쓰이기 전에 정의 레코드가 한 번 나온다 (회전된 파일 하나만으로도 해석 가능).
+// 파일 이름: <SOCKTRACE_BIN>.<pid>.<seq % 파일 수>, seq 는 헤더에 있다.
+// 모든 값은 기록한 머신의 바이트 순서 (같은 머신에서 해석하는 용도).
+#ifndef SOCKTRACE_FMT_H
+#define SOCKTRACE_FMT_H
+
+#include <stdint.h>
+
+#define ST_MAGIC    0x43525453u   // "STRC"
+#define ST_VERSION  2           // 2: op 추가 (벡터/메시지/zero-copy 호출, close/dup), 1 도 해석 가능
+#define ST_REC_SIZE 32
+
+enum {
+    ST_OP_END = 0,      // 유효 데이터 끝
+    ST_OP_CONNECT,      // ret = 0
+    ST_OP_CONNECT_ERR,  // ret = errno
+    ST_OP_ACCEPT,
+    ST_OP_SEND,         // ret = 바이트 수
+    ST_OP_RECV,
+    ST_OP_READ,
+    ST_OP_WRITE,
+    ST_OP_DROP,         // ret = 버린 이벤트 수 (tid 의 링), flags = ST_DROP_* 이유
+    ST_OP_ENDPOINT,     // st_ep_rec_t (64바이트)
+    ST_OP_READV,        // ret = 바이트 수 (모든 iovec 합)
+    ST_OP_WRITEV,
+    ST_OP_RECVMSG,
+    ST_OP_SENDMSG,
+    ST_OP_RECVMMSG,     // ret = 모든 메시지 바이트 합, flags = 메시지 수
+    ST_OP_SENDMMSG,
+    ST_OP_SENDFILE,     // ret = 보낸 바이트 (fd = 소켓 쪽)
+    ST_OP_SPLICE_IN,    // 소켓 → 파이프, ret = 바이트
+    ST_OP_SPLICE_OUT,   // 파이프 → 소켓
+    ST_OP_CLOSE,        // ret = 0
+    ST_OP_DUP,          // fd = 새 FD, ret = 원래 FD (같은 끝점 ID)
+    ST_OP_COUNT
+};
+
+// 데이터를 받는/보내는 op (1 << ST_OP_*)
+#define ST_IN_MASK  (1u << ST_OP_RECV | 1u << ST_OP_READ | 1u << ST_OP_READV | 1u << ST_OP_RECVMSG | \
+                     1u << ST_OP_RECVMMSG | 1u << ST_OP_SPLICE_IN)
+#define ST_OUT_MASK (1u << ST_OP_SEND | 1u << ST_OP_WRITE | 1u << ST_OP_WRITEV | 1u << ST_OP_SENDMSG | \
+                     1u << ST_OP_SENDMMSG | 1u << ST_OP_SENDFILE | 1u << ST_OP_SPLICE_OUT)
+
+// ST_OP_DROP 레코드의 flags
+enum {
+    ST_DROP_RING = 0,   // 링이 가득 참
+    ST_DROP_BUDGET,     // 초당 예산 초과 (SOCKTRACE_BUDGET)
+};
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t rec_size;
+    uint32_t pid;
+    uint32_t seq;          // 회전 순번 (0부터)
+    uint64_t mono_ns;      // 파일을 연 시각 (CLOCK_MONOTONIC)
+    uint64_t real_ns;      // 같은 순간의 CLOCK_REALTIME (절대 시각 환산용)
+    uint32_t sample_n;     // SOCKTRACE_SAMPLE (0 = 샘플링 안 함, 예전 파일도 0)
+    uint32_t sample_us;    // SOCKTRACE_SAMPLE_US
+    uint32_t budget;       // SOCKTRACE_BUDGET (초당 이벤트 상한)
+    uint32_t filtered;     // fd/peer/방향/최소 바이트 필터를 건 추적이면 1
+    uint8_t  pad[16];
+} st_file_hdr_t;
+
+typedef struct {
+    uint16_t op;           // ST_OP_*
+    uint16_t flags;
+    uint32_t tid;
+    int32_t  fd;
+    uint32_t ep;           // 끝점 ID (0 = 모름)
+    uint64_t t_ns;         // 호출 시작 시각 (CLOCK_MONOTONIC)
+    int64_t  ret;
+} st_rec_t;
+
+typedef struct {
+    uint16_t op;           // ST_OP_ENDPOINT
+    uint16_t family;       // AF_INET / AF_INET6 (0 = 모름)
+    uint32_t ep;
+    uint16_t lport, pport; // 호스트 바이트 순서
+    uint8_t  laddr[16];    // IPv4 는 앞 4바이트
+    uint8_t  paddr[16];
+    uint8_t  pad[20];
+} st_ep_rec_t;
+
+#endif
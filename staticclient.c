@@ -1,57 +1,252 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 
-int main() {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
+#include "client_core.h"
+#include "progress.h"
 
-    struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(8888);
-    inet_pton(AF_INET, "115.145.211.117", &server_addr.sin_addr);
+#define MAX_MB      (16LL * 1024 * 1024)   // 요청 크기 상한 16TB (MB 단위)
+#define STREAM_OVER (1024LL * 1024 * 1024) // 이보다 큰 요청은 전체를 메모리에 두지 않고 스트리밍
+#define STREAM_BUF  (4UL * 1024 * 1024)    // 스트리밍 때 돌려 쓰는 버퍼 크기
 
-    connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr));
+// 버퍼 할당 방식 (-a)
+//   malloc : 요청마다 malloc/free (기존 방식, 매번 새 페이지 → 페이지 폴트 + 0 채우기)
+//   pool   : 한 번 매핑해 미리 폴트시킨 영역을 재사용, 더 큰 요청이 올 때만 키움 (기본)
+//   thp    : pool + 2MB 정렬 + MADV_HUGEPAGE (Transparent Huge Page)
+//   huge   : pool + MAP_HUGETLB (예약된 hugepage 필요, 실패 시 thp로 대체)
+enum { A_MALLOC, A_POOL, A_THP, A_HUGE };
+static const char* alloc_names[] = { "malloc", "pool", "thp", "huge" };
+
+#define HUGE_SZ (2UL * 1024 * 1024)
+
+typedef struct {
+    char*  base;
+    size_t cap;
+    int    mode;
+} pool_t;
+
+// 페이지마다 한 바이트씩 써서 미리 폴트시킨다 (수신 중에는 폴트가 없도록)
+static void prefault(char* p, size_t len, size_t step) {
+    for (size_t off = 0; off < len; off += step) p[off] = 0;
+}
+
+// 2MB 경계에 맞춘 익명 매핑 (THP가 처음부터 huge page로 채울 수 있게)
+static char* map_aligned(size_t len) {
+    char* raw = mmap(NULL, len + HUGE_SZ, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char* p = (char*)(((unsigned long)raw + HUGE_SZ - 1) & ~(HUGE_SZ - 1));
+    if (p > raw) munmap(raw, (size_t)(p - raw));
+    munmap(p + len, (size_t)(raw + HUGE_SZ - p));
+    return p;
+}
+
+// size 이상인 버퍼 반환. 이미 충분히 크면 그대로 재사용 (할당 없음)
+static char* pool_get(pool_t* p, size_t size) {
+    if (p->base && p->cap >= size) return p->base;
+    if (p->base) munmap(p->base, p->cap);
+    p->base = NULL;
+
+    size_t cap = (size + HUGE_SZ - 1) & ~(HUGE_SZ - 1);
+    if (p->mode == A_HUGE) {
+        char* m = mmap(NULL, cap, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (m != MAP_FAILED) {
+            p->base = m;
+            p->cap  = cap;
+            return m;
+        }
+        perror("MAP_HUGETLB 실패 (thp로 대체)");
+        p->mode = A_THP;
+    }
+    if (p->mode == A_THP) {
+        char* m = map_aligned(cap);
+        if (!m) return NULL;
+        madvise(m, cap, MADV_HUGEPAGE);
+        prefault(m, cap, 4096);
+        p->base = m;
+        p->cap  = cap;
+        return m;
+    }
+    char* m = mmap(NULL, cap, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (m == MAP_FAILED) return NULL;
+    p->base = m;
+    p->cap  = cap;
+    return m;
+}
+
+// 현재 RSS (MB)
+static double rss_mb(void) {
+    long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f) {
+        if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        fclose(f);
+    }
+    return resident * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
+// -q: 파이프라인 응답은 STREAM_BUF 버퍼 하나를 돌려 쓰며 받는다 (-s 처럼 데이터는 보관 안 함)
+typedef struct {
+    pool_t*              pool;
+    const recv_engine_t* eng;
+    long                 calls;
+} pipe_ctx_t;
+
+static long long pipe_recv(void* arg, int sock, int idx, long long mb) {
+    pipe_ctx_t* c = arg;
+    char* data = c->pool->mode == A_MALLOC ? malloc(STREAM_BUF) : pool_get(c->pool, STREAM_BUF);
+    if (!data) {
+        perror("버퍼 할당 실패");
+        return 0;
+    }
+    long long size = mb * 1024 * 1024, received = 0;
+    recv_stat_t st = { 0, 0 };
+    progress_t pg;
+    progress_start(&pg, progress_counter, &received, size, 1.0);
+    while (received < size) {
+        size_t want = STREAM_BUF;
+        if ((long long)want > size - received) want = (size_t)(size - received);   // 다음 응답은 건드리지 않게
+        ssize_t n = c->eng->fill(sock, data, want, &st);
+        if (n <= 0) break;
+        __atomic_store_n(&received, received + n, __ATOMIC_RELAXED);
+    }
+    progress_stop(&pg);
+    c->calls += st.calls;
+    if (c->pool->mode == A_MALLOC) free(data);
+    return received;
+}
+
+int main(int argc, char* argv[]) {
+    pool_t pool = { NULL, 0, A_POOL };
+    int stream_all = 0;   // -s: 크기와 상관없이 스트리밍
+    int depth = 0;        // -q: 파이프라인 깊이 (0이면 요청 하나씩)
+    client_opt_t co;      // 서버, 엔진(-e, 사용자 버퍼 엔진만), 싱크는 메모리 고정
+    client_init(&co, "read", SINK_MEM);
+    int opt;
+    while ((opt = getopt(argc, argv, "a:sq:" CLIENT_OPTS)) != -1) {
+        int rc = client_opt(&co, opt, optarg);
+        if (rc > 0) continue;
+        if (rc < 0) return 1;
+        if (opt == 's') {
+            stream_all = 1;
+            continue;
+        }
+        if (opt == 'q' && (depth = atoi(optarg)) >= 1) continue;   // 한 줄에 "10 10 10 ..." 입력
+        int m = -1;
+        for (int i = 0; opt == 'a' && i < 4; i++)
+            if (strcmp(optarg, alloc_names[i]) == 0) m = i;
+        if (m < 0) {
+            fprintf(stderr, "사용법: %s [-a malloc|pool|thp|huge] [-s] [-q 파이프라인깊이]\n", argv[0]);
+            client_usage();
+            return 1;
+        }
+        pool.mode = m;
+    }
+    const recv_engine_t* eng = co.eng;
+    if (co.sink != SINK_MEM) {
+        fprintf(stderr, "staticclient 는 메모리 버퍼로 받는 클라이언트 (-o mem 만 가능)\n");
+        return 1;
+    }
+    if (client_check(&co, eng, 1) < 0) return 1;
+
+    int sock = client_connect(&co);   // -H / -p, 없으면 SERVER_IP / SERVER_PORT 환경변수
+    if (sock < 0) {
+        perror("서버 연결 실패");
+        return 1;
+    }
     printf("클라이언트: 서버에 연결됨\n");
 
-    char send_buf[1024], recv_buf[4096];
+    char send_buf[1024];
 
     while (1) {
         printf("입력 > ");
-        fgets(send_buf, sizeof(send_buf), stdin);
+        if (!fgets(send_buf, sizeof(send_buf), stdin)) break;
         send_buf[strcspn(send_buf, "\n")] = '\0';
 
-        write(sock, send_buf, strlen(send_buf));
-
-        if (strncmp(send_buf, "exit", 4) == 0)
+        if (strncmp(send_buf, "exit", 4) == 0) {
+            write(sock, send_buf, strlen(send_buf));
             break;
+        }
 
-        int mb = atoi(send_buf);
-        if (mb <= 0 || mb > 100) {
+        if (depth > 0) {
+            pipe_ctx_t c = { &pool, eng, 0 };
+            client_pipe_t hook = { NULL, NULL, pipe_recv, NULL, &c };
+            client_pipeline(sock, send_buf, depth, &hook);
+            printf("수신 방식: %s, 호출 %ld회\n", eng->name, c.calls);
+            continue;
+        }
+
+        write(sock, send_buf, strlen(send_buf));
+
+        long long mb = atoll(send_buf);
+        if (mb <= 0 || mb > MAX_MB) {
             printf("클라이언트: 잘못된 요청 크기\n");
             continue;
         }
 
-        int size = mb * 1024 * 1024; //원하는 크기 (MB 단위)
-        printf("클라이언트: %d MB 요청\n", mb);
-        char *data = malloc(size); // 원하는 데이터크기만큼의 메모리 할당
-        int received = 0;
+        long long size = mb * 1024 * 1024; //원하는 크기 (MB 단위, 64비트)
+        // 큰 요청은 STREAM_BUF 크기 버퍼 하나를 돌려 쓰며 받는다: 메모리 사용량이 요청 크기와 무관
+        int stream = stream_all || size > STREAM_OVER;
+        size_t bufsz = stream ? STREAM_BUF : (size_t)size;
+        printf("클라이언트: %lld MB 요청%s\n", mb, stream ? " (스트리밍: 버퍼 재사용, 데이터는 보관 안 함)" : "");
 
+        // 할당 + 수신 + 해제 구간의 페이지 폴트를 잰다
+        struct rusage ru0, ru1;
+        getrusage(RUSAGE_SELF, &ru0);
+
+        char *data = (pool.mode == A_MALLOC)
+                   ? malloc(bufsz)                  // 원하는 데이터크기만큼의 메모리 할당
+                   : pool_get(&pool, bufsz);        // 풀에서 재사용
+        if (!data) {
+            perror("버퍼 할당 실패");
+            break;
+        }
+        long long received = 0;
+        recv_stat_t st = { 0, 0 };
+        char head[17] = "";   // 앞부분 16바이트 (스트리밍이면 버퍼가 덮어쓰이므로 따로 보관)
+
+        progress_t pg;
+        progress_start(&pg, progress_counter, &received, size, 1.0);
+        double start = progress_now();
         while (received < size) {
-            int n = read(sock, data + received, size - received);
+            size_t at   = stream ? (size_t)(received % (long long)bufsz) : (size_t)received;
+            size_t want = bufsz - at;
+            if ((long long)want > size - received) want = (size_t)(size - received);
+            if (want > STREAM_BUF) want = STREAM_BUF;   // MSG_WAITALL 류도 진행 표시가 갱신되도록
+            ssize_t n = eng->fill(sock, data + at, want, &st);
             if (n <= 0) break;
-            received += n;
+            if (received < 16) memcpy(head + received, data + at, (size_t)(n < 16 - received ? n : 16 - received));
+            __atomic_store_n(&received, received + n, __ATOMIC_RELAXED);   // 진행 표시가 동시에 읽음
         }
+        double elapsed = progress_now() - start;
+        progress_stop(&pg);
+
+        printf("클라이언트: 총 %lld 바이트 수신 완료\n", received);
+        printf("앞부분: %.16s\n", head);  // 더미 데이터 확인용
+        printf("⏱ 소요 시간: %.6f 초\n", elapsed);   // 다른 클라이언트와 같은 형식 (bench 가 읽음)
+        printf(" 평균 속도: %.2f MB/s\n", elapsed > 0.0 ? received / (1024.0 * 1024.0) / elapsed : 0.0);
+        printf("수신 방식: %s, 호출 %ld회\n", eng->name, st.calls);
+        double rss = rss_mb();            // 해제 전 RSS (수신 데이터가 올라가 있는 상태)
+        if (pool.mode == A_MALLOC) free(data);
 
-        printf("클라이언트: 총 %d 바이트 수신 완료\n", received);
-        printf("앞부분: %.16s\n", data);  // 더미 데이터 확인용
-        free(data);
+        getrusage(RUSAGE_SELF, &ru1);
+        printf("메모리: %s, 페이지 폴트 minor %ld / major %ld, RSS %.1f MB",
+               alloc_names[pool.mode],
+               ru1.ru_minflt - ru0.ru_minflt, ru1.ru_majflt - ru0.ru_majflt, rss);
+        if (pool.mode != A_MALLOC) printf(", 풀 용량 %.1f MB", pool.cap / (1024.0 * 1024.0));
+        printf("\n");
     }
 
+    if (pool.base) munmap(pool.base, pool.cap);
     close(sock);
     return 0;
 }
 //read는 커널의 TCP 수신버퍼에서
-//데이터를 읽어오는 함수로, 실제로는 커널에서 TCP 세그먼트를 처리하여 
-//수신 버퍼에 저장된 데이터를 사용자 공간으로 복사합니다.
\ No newline at end of file
+//데이터를 읽어오는 함수로, 실제로는 커널에서 TCP 세그먼트를 처리하여
+//수신 버퍼에 저장된 데이터를 사용자 공간으로 복사합니다.